@@ -0,0 +1,141 @@
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <numeric>
+#include <string>
+
+#include "src/allocator/allocator.h"
+#include "src/allocator/mapped_arena.h"
+
+// Builds a large std::list through each arena backend, sorts it so that list
+// order no longer follows address order, and walks it. The walk is one
+// dependent load per node at random addresses, which is where page size shows
+// up as data TLB misses. Counters need perf_event_open; where it is not
+// permitted they read n/a.
+
+namespace {
+
+const std::size_t kDefaultNodes = std::size_t(1) << 23;
+const int kWalks = 4;
+
+volatile long long sink;
+
+class Counter {
+public:
+    Counter(std::uint32_t type, std::uint64_t config) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        _fd = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    Counter(const Counter&) = delete;
+    Counter& operator=(const Counter&) = delete;
+
+    ~Counter() {
+        if (_fd >= 0)
+            ::close(_fd);
+    }
+
+    void start() {
+        if (_fd >= 0) {
+            ::ioctl(_fd, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(_fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    std::string stop() {
+        std::uint64_t value = 0;
+        if (_fd < 0)
+            return "n/a";
+        ::ioctl(_fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (::read(_fd, &value, sizeof(value)) != sizeof(value))
+            return "n/a";
+        return std::to_string(value);
+    }
+
+private:
+    int _fd;
+};
+
+Counter DtlbMisses() {
+    return Counter(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                       (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+}
+
+Counter PageFaults() {
+    return Counter(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+}
+
+template <class F>
+double MeasureMs(F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+template <class Allocator>
+void Run(const std::string& name, const Allocator& allocator, std::size_t nodes) {
+    std::list<long, Allocator> list(allocator);
+    Counter build_faults = PageFaults();
+    build_faults.start();
+    double build_ms = MeasureMs([&] {
+        std::uint64_t value = 88172645463325252ull;
+        for (std::size_t i = 0; i < nodes; i++) {
+            value ^= value << 13;
+            value ^= value >> 7;
+            value ^= value << 17;
+            list.push_back(static_cast<long>(value >> 1));
+        }
+    });
+    std::string faults = build_faults.stop();
+    list.sort();
+
+    long long sum = 0;
+    Counter walk_misses = DtlbMisses();
+    walk_misses.start();
+    double walk_ms = MeasureMs([&] {
+        for (int walk = 0; walk < kWalks; walk++)
+            sum += std::accumulate(list.begin(), list.end(), 0LL);
+    });
+    std::string misses = walk_misses.stop();
+    sink = sum;
+
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << nodes / build_ms / 1000
+              << std::setw(14) << faults
+              << std::setw(12) << kWalks * nodes / walk_ms / 1000
+              << std::setw(16) << misses << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::size_t nodes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : kDefaultNodes;
+
+    std::cout << nodes << " nodes, throughput in Mnodes/s\n";
+    std::cout << std::left << std::setw(24) << "arena" << std::right
+              << std::setw(12) << "build" << std::setw(14) << "page faults"
+              << std::setw(12) << "walk" << std::setw(16) << "dTLB misses" << "\n";
+
+    Run("operator new blocks", CustomAllocator<long>(), nodes);
+    Run("mmap + THP", MappedAllocator<long>(), nodes);
+    auto prefaulted = std::make_shared<detail::MappedArena>(
+        detail::MappedArena::kFirstBlockSize, detail::MappedBlocks(detail::MappedBlocks::kDefaultReservation, true));
+    Run("mmap + THP, prefaulted", MappedAllocator<long>(prefaulted), nodes);
+    return 0;
+}
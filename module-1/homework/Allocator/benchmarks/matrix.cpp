@@ -0,0 +1,229 @@
+#include <malloc.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <memory_resource>
+#include <string>
+
+#include "src/allocator/allocator.h"
+#include "src/allocator/arena_resource.h"
+#include "src/allocator/concurrent_allocator.h"
+#include "src/allocator/mapped_arena.h"
+#include "src/allocator/slab_allocator.h"
+#include "src/allocator/stats_allocator.h"
+#include "src/list/list.h"
+
+// Runs task::list and std::list over every allocator in the tree, for int and
+// for 64-byte payloads, through four workloads:
+//
+//   churn  a list of kLiveNodes that gets a push back and a pop front per op
+//   build  n push backs, then the list is dropped
+//   sort   n random values sorted once
+//   erase  every other element of n at random erased, then as many pushed
+//          back into the holes the erases left in the allocator
+//
+// Each cell is run twice: once as is for throughput and peak RSS, and once
+// with the allocator wrapped in StatsAllocator to count allocate and
+// deallocate calls. Peak RSS is the VmHWM of the process, reset through
+// /proc/self/clear_refs before every run; where that is not permitted it is
+// the peak of the whole process so far.
+
+namespace {
+
+const std::size_t kDefaultElements = std::size_t(1) << 20;
+const std::size_t kLiveNodes = 1024;
+
+struct Payload {
+    explicit Payload(std::uint64_t v) { words.fill(v); }
+
+    bool operator<(const Payload& other) const { return words[0] < other.words[0]; }
+
+    std::array<std::uint64_t, 8> words;
+};
+
+static_assert(sizeof(Payload) == 64, "Payload should take a cache line");
+
+volatile std::uint64_t sink;
+
+std::uint64_t Key(int value) { return static_cast<std::uint64_t>(value); }
+std::uint64_t Key(const Payload& value) { return value.words[0]; }
+
+class Random {
+public:
+    std::uint64_t next() {
+        _state ^= _state << 13;
+        _state ^= _state >> 7;
+        _state ^= _state << 17;
+        return _state;
+    }
+
+private:
+    std::uint64_t _state = 88172645463325252ull;
+};
+
+template <class T, class A>
+void PushBack(std::list<T, A>& list, std::uint64_t value) { list.emplace_back(static_cast<T>(value)); }
+template <class T, class A>
+void PushBack(task::list<T, A>& list, std::uint64_t value) { list.emplaceBack(static_cast<T>(value)); }
+
+template <class T, class A>
+void PopFront(std::list<T, A>& list) { list.pop_front(); }
+template <class T, class A>
+void PopFront(task::list<T, A>& list) { list.popFront(); }
+
+void ResetPeakRss() {
+    // Hand freed heap pages back first so earlier runs do not count here.
+    ::malloc_trim(0);
+    std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+std::size_t PeakRssKb() {
+    std::ifstream status("/proc/self/status");
+    std::string key;
+    while (status >> key) {
+        if (key == "VmHWM:") {
+            std::size_t kb = 0;
+            status >> kb;
+            return kb;
+        }
+        status.ignore(256, '\n');
+    }
+    return 0;
+}
+
+template <class F>
+double MeasureMs(F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+// Runs `workload` on a fresh list and returns the number of operations timed.
+template <class List>
+std::size_t Workload(const std::string& name, List& list, std::size_t n, double& ms) {
+    Random random;
+    if (name == "churn") {
+        for (std::size_t i = 0; i < kLiveNodes; i++)
+            PushBack(list, random.next());
+        ms = MeasureMs([&] {
+            for (std::size_t i = 0; i < n; i++) {
+                PushBack(list, random.next());
+                PopFront(list);
+            }
+        });
+        return n;
+    }
+    if (name == "build") {
+        ms = MeasureMs([&] {
+            for (std::size_t i = 0; i < n; i++)
+                PushBack(list, random.next());
+            List dropped(std::move(list));
+        });
+        return n;
+    }
+    for (std::size_t i = 0; i < n; i++)
+        PushBack(list, random.next());
+    if (name == "sort") {
+        ms = MeasureMs([&] { list.sort(); });
+        sink = Key(list.front());
+        return n;
+    }
+    std::size_t erased = 0;
+    ms = MeasureMs([&] {
+        for (auto it = list.begin(); it != list.end();) {
+            if (random.next() & 1) {
+                it = list.erase(it);
+                erased++;
+            } else {
+                ++it;
+            }
+        }
+        for (std::size_t i = 0; i < erased; i++)
+            PushBack(list, random.next());
+    });
+    return 2 * erased;
+}
+
+const char* const kWorkloads[] = {"churn", "build", "sort", "erase"};
+
+template <template <class, class> class List, class T, class Allocator>
+void RunCell(const std::string& row, const std::string& workload, const Allocator& prototype, std::size_t n) {
+    using ValueAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+    ValueAllocator allocator(prototype);
+
+    ResetPeakRss();
+    double ms = 0;
+    std::size_t ops;
+    {
+        List<T, ValueAllocator> list(allocator);
+        ops = Workload(workload, list, n, ms);
+    }
+    std::size_t peak_kb = PeakRssKb();
+
+    double counted_ms = 0;
+    StatsAllocator<ValueAllocator> counted(allocator);
+    {
+        List<T, StatsAllocator<ValueAllocator>> list(counted);
+        Workload(workload, list, n, counted_ms);
+    }
+    const AllocationStats& stats = counted.stats();
+
+    std::cout << std::left << std::setw(8) << workload << std::setw(36) << row << std::right << std::fixed
+              << std::setprecision(1) << std::setw(10) << ops / ms / 1000
+              << std::setw(12) << peak_kb / 1024.0
+              << std::setw(12) << stats.allocations
+              << std::setw(12) << stats.deallocations << "\n";
+}
+
+// `with_allocator` calls its argument with a fresh allocator, of any value
+// type, that stays valid for the duration of the call.
+template <class T, class WithAllocator>
+void RunAllocator(const std::string& name, const std::string& type, std::size_t n, WithAllocator with_allocator) {
+    for (const char* workload : kWorkloads) {
+        with_allocator([&](const auto& allocator) {
+            RunCell<task::list, T>("task::list<" + type + ", " + name + ">", workload, allocator, n);
+        });
+        with_allocator([&](const auto& allocator) {
+            RunCell<std::list, T>("std::list<" + type + ", " + name + ">", workload, allocator, n);
+        });
+    }
+}
+
+template <class T>
+void RunPayload(const std::string& type, std::size_t n) {
+    RunAllocator<T>("std::allocator", type, n, [](auto body) { body(std::allocator<char>()); });
+    RunAllocator<T>("Custom", type, n, [](auto body) { body(CustomAllocator<char>()); });
+    RunAllocator<T>("Slab", type, n, [](auto body) { body(SlabAllocator<char>()); });
+    RunAllocator<T>("Mapped", type, n, [](auto body) { body(MappedAllocator<char>()); });
+    RunAllocator<T>("Concurrent", type, n, [](auto body) { body(ConcurrentAllocator<char>()); });
+    RunAllocator<T>("ThreadCaching", type, n, [](auto body) { body(ThreadCachingAllocator<char>()); });
+    RunAllocator<T>("pmr Pooled", type, n, [](auto body) {
+        PooledArenaResource resource;
+        body(std::pmr::polymorphic_allocator<char>(&resource));
+    });
+    RunAllocator<T>("pmr Monotonic", type, n, [](auto body) {
+        MonotonicArenaResource resource;
+        body(std::pmr::polymorphic_allocator<char>(&resource));
+    });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : kDefaultElements;
+
+    std::cout << n << " elements per workload, throughput in Mops/s\n";
+    std::cout << std::left << std::setw(8) << "load" << std::setw(36) << "container" << std::right
+              << std::setw(10) << "Mops/s" << std::setw(12) << "peak MiB"
+              << std::setw(12) << "allocs" << std::setw(12) << "deallocs" << "\n";
+    RunPayload<int>("int", n);
+    RunPayload<Payload>("Payload", n);
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "src/allocator/concurrent_allocator.h"
+
+// Every thread churns a private std::list through one shared allocator, so the
+// only contention is inside the allocator. std::allocator is the baseline.
+
+namespace {
+
+const int kOpsPerThread = 1 << 20;
+const int kLiveNodes = 1024;
+
+template <class F>
+double MeasureMs(F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+template <class Allocator>
+void Churn(const Allocator& allocator) {
+    std::list<long, Allocator> list(allocator);
+    for (int i = 0; i < kLiveNodes; i++)
+        list.push_back(i);
+    for (int i = 0; i < kOpsPerThread; i++) {
+        list.push_back(i);
+        list.pop_front();
+    }
+}
+
+// Millions of push/pop pairs per second over all threads.
+template <class Allocator>
+double Throughput(int threads) {
+    Allocator allocator;
+    double ms = MeasureMs([&] {
+        std::vector<std::thread> workers;
+        for (int thread = 0; thread < threads; thread++)
+            workers.emplace_back([&allocator] { Churn(allocator); });
+        for (std::thread& worker : workers)
+            worker.join();
+    });
+    return static_cast<double>(threads) * kOpsPerThread / ms / 1000;
+}
+
+void Report(int threads, double standard, double concurrent, double caching) {
+    std::cout << std::setw(8) << threads << std::fixed << std::setprecision(2)
+              << std::setw(16) << standard
+              << std::setw(16) << concurrent
+              << std::setw(16) << caching << "\n";
+}
+
+}  // namespace
+
+int main() {
+    std::cout << "push/pop churn, Mops/s (" << std::thread::hardware_concurrency() << " hardware threads)\n";
+    std::cout << std::setw(8) << "threads"
+              << std::setw(16) << "std::allocator"
+              << std::setw(16) << "concurrent"
+              << std::setw(16) << "thread-caching" << "\n";
+    for (int threads : {1, 2, 4, 8}) {
+        Report(threads,
+               Throughput<std::allocator<long>>(threads),
+               Throughput<ConcurrentAllocator<long>>(threads),
+               Throughput<ThreadCachingAllocator<long>>(threads));
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <ratio>
+#include <string>
+#include <vector>
+
+#include "src/allocator/allocator.h"
+#include "src/vector/vector.h"
+
+// Fills vectors by push back, with and without reserve, and compares
+// task::vector at two growth factors with std::vector. The element types cover
+// the three ways to relocate on growth: int (memcpy everywhere), std::string
+// (nothrow move) and a unique_ptr holder that only task::vector knows to be
+// trivially relocatable.
+
+namespace {
+
+const std::size_t kDefaultElements = std::size_t(1) << 22;
+const int kRounds = 8;
+
+struct Owner {
+    explicit Owner(std::size_t v) : value(std::make_unique<std::size_t>(v)) {}
+
+    std::unique_ptr<std::size_t> value;
+};
+
+}  // namespace
+
+template <>
+struct task::IsTriviallyRelocatable<Owner> : std::true_type {};
+
+namespace {
+
+volatile std::size_t sink;
+
+template <class F>
+double MeasureMs(F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+template <class Vector, class Push>
+void Run(const std::string& name, std::size_t elements, Push push) {
+    auto fill = [&](bool reserve) {
+        return MeasureMs([&] {
+            for (int round = 0; round < kRounds; round++) {
+                Vector vector;
+                if (reserve)
+                    vector.reserve(elements);
+                for (std::size_t i = 0; i < elements; i++)
+                    push(vector, i);
+                sink = vector.size();
+            }
+        });
+    };
+    double grown_ms = fill(false);
+    double reserved_ms = fill(true);
+    std::cout << std::left << std::setw(36) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << kRounds * elements / grown_ms / 1000
+              << std::setw(12) << kRounds * elements / reserved_ms / 1000 << "\n";
+}
+
+template <class T, class Make>
+void RunAll(const std::string& type, std::size_t elements, Make make) {
+    auto push_std = [&](auto& vector, std::size_t i) { vector.push_back(make(i)); };
+    auto push_task = [&](auto& vector, std::size_t i) { vector.pushBack(make(i)); };
+    Run<std::vector<T>>("std::vector<" + type + ">", elements, push_std);
+    Run<task::vector<T>>("task::vector<" + type + ">", elements, push_task);
+    Run<task::vector<T, std::allocator<T>, std::ratio<3, 2>>>("task::vector<" + type + ">, x1.5", elements,
+                                                              push_task);
+    Run<task::vector<T, CustomAllocator<T>>>("task::vector<" + type + ">, arena", elements, push_task);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::size_t elements = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : kDefaultElements;
+
+    std::cout << elements << " push backs x " << kRounds << ", throughput in Mops/s\n";
+    std::cout << std::left << std::setw(36) << "container" << std::right
+              << std::setw(12) << "grown" << std::setw(12) << "reserved" << "\n";
+
+    RunAll<int>("int", elements, [](std::size_t i) { return static_cast<int>(i); });
+    RunAll<std::string>("string", elements / 4, [](std::size_t i) { return std::string(24, char('a' + i % 26)); });
+    RunAll<Owner>("Owner", elements / 4, [](std::size_t i) { return Owner(i); });
+    return 0;
+}
@@ -1,7 +1,253 @@
 // Implemented by Taimuraz Tibilov, based on Linear Allocator principle
 
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <new>
+#include <scoped_allocator>
 #include <type_traits>
+#include <utility>
+
+namespace detail {
+
+// Where an arena gets its memory from. A block source hands out regions of at
+// least the requested size and frees all of them when it is destroyed. Its
+// position() names everything obtained so far, and rewind(position) frees
+// whatever was obtained after it.
+struct Region {
+    char* begin;
+    std::size_t size;
+};
+
+// Blocks from ::operator new, chained through a header in front of each.
+class HeapBlocks {
+public:
+    HeapBlocks() = default;
+    HeapBlocks(HeapBlocks&& other) noexcept : _blocks(other._blocks), _capacity(other._capacity) {
+        other._blocks = nullptr;
+        other._capacity = 0;
+    }
+    HeapBlocks& operator=(HeapBlocks&&) = delete;
+    ~HeapBlocks();
+
+    Region obtain(std::size_t min_bytes);
+
+    struct Block;
+    using Position = Block*;
+
+    Position position() const noexcept { return _blocks; }
+    void rewind(Position position) noexcept;
+
+    // Bytes obtained from ::operator new, block headers included.
+    std::size_t capacity() const noexcept { return _capacity; }
+    std::size_t blockCount() const noexcept;
+
+    struct alignas(std::max_align_t) Block {
+        Block* next;
+        std::size_t size;  // usable bytes after the header
+
+        char* begin() { return reinterpret_cast<char*>(this + 1); }
+    };
+
+private:
+    Block* _blocks = nullptr;
+    std::size_t _capacity = 0;
+};
+
+inline HeapBlocks::~HeapBlocks() {
+    rewind(nullptr);
+}
+
+inline void HeapBlocks::rewind(Position position) noexcept {
+    while (_blocks != position) {
+        Block* next = _blocks->next;
+        _capacity -= sizeof(Block) + _blocks->size;
+        ::operator delete(_blocks);
+        _blocks = next;
+    }
+}
+
+inline Region HeapBlocks::obtain(std::size_t min_bytes) {
+    if (min_bytes > std::numeric_limits<std::size_t>::max() - sizeof(Block))
+        throw std::bad_alloc();
+    void* memory = ::operator new(sizeof(Block) + min_bytes);
+    _blocks = ::new(memory) Block{_blocks, min_bytes};
+    _capacity += sizeof(Block) + min_bytes;
+    return {_blocks->begin(), min_bytes};
+}
+
+inline std::size_t HeapBlocks::blockCount() const noexcept {
+    std::size_t count = 0;
+    for (Block* block = _blocks; block != nullptr; block = block->next)
+        ++count;
+    return count;
+}
+
+// Linear arena behind CustomAllocator: a chain of blocks, each one twice the
+// size of the previous one up to kMaxBlockSize. Allocations bump a byte cursor
+// through the newest block, aligned for whatever type asks, so allocators of
+// different types rebound from one another can share it. A request that does
+// not fit opens the next block (or a block of its own if it is larger than
+// that), and the rest of the old block is left unused unless the new block
+// directly follows it. Every block is freed together with the arena.
+//
+// Small requests (up to kMaxPooledSize bytes, alignment up to kSizeClassStep)
+// are rounded up to a multiple of kSizeClassStep. Each such size class keeps an
+// intrusive free list of deallocated chunks that the next request of the class
+// reuses in O(1), so a container that keeps inserting and erasing nodes runs
+// in constant memory. Larger or over-aligned memory is only reclaimed with the
+// arena.
+//
+// Blocks come from BlockSource, HeapBlocks for the default Arena.
+//
+// mark() and rewind() drop everything allocated after a point in O(1) per
+// block, without visiting the allocations; reset() drops everything. The
+// contract for containers on a rewound arena:
+//  - Memory allocated after the mark is gone. A container that holds any of
+//    it must either be destroyed before the rewind, or never be touched
+//    again afterwards, not even by its destructor.
+//  - Skipping destructors like that is only correct for elements that own
+//    nothing outside the arena: trivially destructible types, or types whose
+//    own allocations come from the same arena after the same mark. Keep such
+//    containers themselves in storage that is never destroyed, e.g. built
+//    with placement new in the arena, and give them a CustomAllocator that
+//    borrows the arena, since an owning one would never be released.
+//  - A container that allocated before the mark may outlive the rewind only
+//    if it did not allocate after the mark.
+//  - Chunks on the free lists may lie past the mark, so rewind() empties
+//    them; chunks freed before the rewind are reused only after a reset().
+//  - Marks are valid until a rewind to an earlier mark or a reset().
+template <typename BlockSource>
+class BasicArena {
+public:
+    static constexpr std::size_t kFirstBlockSize = 1 << 16;
+    static constexpr std::size_t kMaxBlockSize = 1 << 26;
+    static constexpr std::size_t kSizeClassStep = alignof(std::max_align_t);
+    static constexpr std::size_t kMaxPooledSize = 512;
+
+    explicit BasicArena(std::size_t first_block_size = kFirstBlockSize, BlockSource source = BlockSource());
+    BasicArena(const BasicArena&) = delete;
+    BasicArena& operator=(const BasicArena&) = delete;
+
+    // `alignment` must be a power of two.
+    void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t));
+
+    // `bytes` and `alignment` must be the ones `p` was allocated with.
+    void deallocate(void* p, std::size_t bytes, std::size_t alignment = alignof(std::max_align_t)) noexcept;
+
+    // Carves `bytes` off the newest block, bypassing the free lists. Memory
+    // obtained here is only released with the arena and must not be passed to
+    // deallocate().
+    void* bump(std::size_t bytes, std::size_t alignment);
+
+    struct Mark {
+        typename BlockSource::Position position;
+        char* cursor;
+        char* end;
+        std::size_t next_block_size;
+    };
+
+    Mark mark() const noexcept { return {_source.position(), _cursor, _end, _next_block_size}; }
+    void rewind(const Mark& mark) noexcept;
+    void reset() noexcept { rewind(_empty); }
+
+    std::size_t capacity() const noexcept { return _source.capacity(); }
+    std::size_t blockCount() const noexcept { return _source.blockCount(); }
+    const BlockSource& source() const noexcept { return _source; }
+
+private:
+    struct FreeChunk {
+        FreeChunk* next;
+    };
+
+    static constexpr std::size_t kSizeClasses = kMaxPooledSize / kSizeClassStep;
+
+    static bool pooled(std::size_t bytes, std::size_t alignment) noexcept {
+        return bytes != 0 && bytes <= kMaxPooledSize && alignment <= kSizeClassStep;
+    }
+
+    static std::size_t sizeClass(std::size_t bytes) noexcept {
+        return (bytes - 1) / kSizeClassStep;
+    }
+
+    void grow(std::size_t min_bytes);
+
+    BlockSource _source;
+    FreeChunk* _free[kSizeClasses] = {};
+    char* _cursor = nullptr;
+    char* _end = nullptr;
+    std::size_t _next_block_size;
+    const Mark _empty;
+};
+
+using Arena = BasicArena<HeapBlocks>;
+
+template <typename BlockSource>
+BasicArena<BlockSource>::BasicArena(std::size_t first_block_size, BlockSource source)
+    : _source(std::move(source)),
+      _next_block_size(std::max<std::size_t>(first_block_size, 1)),
+      _empty(mark()) {}
+
+template <typename BlockSource>
+void* BasicArena<BlockSource>::allocate(std::size_t bytes, std::size_t alignment) {
+    if (!pooled(bytes, alignment))
+        return bump(bytes, alignment);
+    std::size_t size_class = sizeClass(bytes);
+    if (FreeChunk* chunk = _free[size_class]) {
+        _free[size_class] = chunk->next;
+        return chunk;
+    }
+    return bump((size_class + 1) * kSizeClassStep, kSizeClassStep);
+}
+
+template <typename BlockSource>
+void BasicArena<BlockSource>::deallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept {
+    if (p == nullptr || !pooled(bytes, alignment))
+        return;
+    std::size_t size_class = sizeClass(bytes);
+    _free[size_class] = ::new(p) FreeChunk{_free[size_class]};
+}
+
+template <typename BlockSource>
+void* BasicArena<BlockSource>::bump(std::size_t bytes, std::size_t alignment) {
+    std::size_t padding = -reinterpret_cast<std::uintptr_t>(_cursor) & (alignment - 1);
+    if (static_cast<std::size_t>(_end - _cursor) < padding ||
+        static_cast<std::size_t>(_end - _cursor) - padding < bytes) {
+        // Block starts are only max_align_t aligned; reserve room for more.
+        std::size_t slack = alignment > alignof(std::max_align_t) ? alignment - alignof(std::max_align_t) : 0;
+        if (bytes > std::numeric_limits<std::size_t>::max() - slack)
+            throw std::bad_alloc();
+        grow(bytes + slack);
+        padding = -reinterpret_cast<std::uintptr_t>(_cursor) & (alignment - 1);
+    }
+    void* result = _cursor + padding;
+    _cursor += padding + bytes;
+    return result;
+}
+
+template <typename BlockSource>
+void BasicArena<BlockSource>::rewind(const Mark& mark) noexcept {
+    _source.rewind(mark.position);
+    std::fill(std::begin(_free), std::end(_free), nullptr);
+    _cursor = mark.cursor;
+    _end = mark.end;
+    _next_block_size = mark.next_block_size;
+}
+
+template <typename BlockSource>
+void BasicArena<BlockSource>::grow(std::size_t min_bytes) {
+    Region region = _source.obtain(std::max(_next_block_size, min_bytes));
+    if (region.begin != _end)
+        _cursor = region.begin;
+    _end = region.begin + region.size;
+    _next_block_size = std::min(_next_block_size * 2, std::max(kMaxBlockSize, _next_block_size));
+}
+
+}  // namespace detail
 
 template <typename T>
 class CustomAllocator {
@@ -20,22 +266,39 @@ public:
     using pointer_difference = std::ptrdiff_t;
     using propagate_on_container_copy_assignment = std::false_type;
     using propagate_on_container_move_assignment = std::false_type;
-    using propogate_on_container_swap = std::false_type;
+    // Swapped containers keep using the arena their nodes came from.
+    using propagate_on_container_swap = std::true_type;
     using is_always_equal = std::false_type;
 
     CustomAllocator();
     CustomAllocator(const CustomAllocator& other) noexcept;
     ~CustomAllocator();
 
+    // Borrows `arena` instead of sharing ownership of a new one. Neither this
+    // allocator nor its copies keep the arena alive, so it must outlive them,
+    // but containers that are abandoned after a rewind hold nothing either.
+    explicit CustomAllocator(detail::Arena& arena) noexcept;
+
+    // Implicit, so that std::uses_allocator sees containers of any value type
+    // over this allocator as able to take it.
     template <typename U>
-    explicit CustomAllocator(const CustomAllocator<U>& other) noexcept;
+    CustomAllocator(const CustomAllocator<U>& other) noexcept;
 
     pointer allocate(size_type n);
     void deallocate(T* p, size_t n);
     template <typename... Args>
     void construct(pointer p, Args&&... args) noexcept(std::is_nothrow_constructible_v<value_type, Args...>);
     void destroy(pointer p) noexcept(std::is_nothrow_destructible_v<value_type>);
-    size_type max_size();
+    size_type max_size() const noexcept;
+
+    // The arena shared by this allocator, its copies and its rebinds.
+    const detail::Arena& arena() const noexcept { return *_arena; }
+
+    // Checkpoints of the shared arena, see detail::BasicArena for the contract.
+    using Mark = detail::Arena::Mark;
+    Mark mark() const noexcept { return _arena->mark(); }
+    void rewind(const Mark& mark) noexcept { _arena->rewind(mark); }
+    void reset() noexcept { _arena->reset(); }
 
     template <typename K, typename U>
     friend bool operator==(const CustomAllocator<K>& lhs, const CustomAllocator<U>& rhs) noexcept;
@@ -43,10 +306,11 @@ public:
     friend bool operator!=(const CustomAllocator<K>& lhs, const CustomAllocator<U>& rhs) noexcept;
 
 private:
-    void* _arena;
-    int* _offset;
-    int* _ref_count;
-    int _arena_size = 65536; // 2 ^ 16
+    template <typename U>
+    friend class CustomAllocator;
+
+    // The last copy of the allocator frees every block of the arena.
+    std::shared_ptr<detail::Arena> _arena;
 };
 
 template <typename T, typename U>
@@ -60,51 +324,33 @@ bool operator!=(const CustomAllocator<T>& lhs, const CustomAllocator<U>& rhs) no
 }
 
 template<typename T>
-CustomAllocator<T>::CustomAllocator() {
-    _arena = ::operator new(_arena_size * sizeof(T));
-    _offset = new int(0);
-    _ref_count = new int(1);
-}
+CustomAllocator<T>::CustomAllocator() : _arena(std::make_shared<detail::Arena>()) {}
 
 template<typename T>
-CustomAllocator<T>::CustomAllocator(const CustomAllocator& other) noexcept :
-    _arena(other._arena),
-    _offset(other._offset),
-    _ref_count(other._ref_count)
-{
-    (*_ref_count)++;
-}
+CustomAllocator<T>::CustomAllocator(const CustomAllocator& other) noexcept : _arena(other._arena) {}
+
+template<typename T>
+CustomAllocator<T>::CustomAllocator(detail::Arena& arena) noexcept
+    : _arena(std::shared_ptr<detail::Arena>(), &arena) {}
 
 template<typename T>
 template<typename U>
-CustomAllocator<T>::CustomAllocator(const CustomAllocator<U>& other) noexcept :
-    _arena(other._arena),
-    _offset(other._offset),
-    _ref_count(other._ref_count)
-{
-    (*_ref_count)++;
-}
+CustomAllocator<T>::CustomAllocator(const CustomAllocator<U>& other) noexcept : _arena(other._arena) {}
 
 template<typename T>
-CustomAllocator<T>::~CustomAllocator() {
-    if (--(*_ref_count) == 0) {
-        ::operator delete(_arena);
-        delete _offset;
-        delete _ref_count;
-    }
-}
+CustomAllocator<T>::~CustomAllocator() = default;
 
 template<typename T>
 T* CustomAllocator<T>::allocate(std::size_t n) {
     if (n > max_size())
         throw std::bad_alloc();
-    int offset = *_offset;
-    *_offset += n;
-    return static_cast<pointer>(_arena) + offset;
+    return static_cast<pointer>(_arena->allocate(n * sizeof(T), alignof(T)));
 }
 
 template<typename T>
-void CustomAllocator<T>::deallocate(T* p, std::size_t n) {}
+void CustomAllocator<T>::deallocate(T* p, std::size_t n) {
+    _arena->deallocate(p, n * sizeof(T), alignof(T));
+}
 
 template<typename T>
 template<typename... Args>
@@ -118,6 +364,18 @@ void CustomAllocator<T>::destroy(CustomAllocator::pointer p) noexcept(std::is_no
 }
 
 template<typename T>
-std::size_t CustomAllocator<T>::max_size() {
-    return _arena_size - *_offset;
-}
\ No newline at end of file
+std::size_t CustomAllocator<T>::max_size() const noexcept {
+    return std::numeric_limits<size_type>::max() / sizeof(T);
+}
+
+// CustomAllocator that also hands its arena down to the elements it constructs
+// when they are allocator-aware themselves, so that a whole nested structure
+// lives in one arena and goes away with it:
+//
+//   using Row = std::vector<int, CustomAllocator<int>>;
+//   task::list<Row, ScopedCustomAllocator<Row>> rows{ScopedCustomAllocator<Row>(arena)};
+//
+// Elements copied or moved into such a container land in its arena too,
+// whatever allocator the source used.
+template <typename T>
+using ScopedCustomAllocator = std::scoped_allocator_adaptor<CustomAllocator<T>>;
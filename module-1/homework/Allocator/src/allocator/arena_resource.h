@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+#include "allocator.h"
+
+// std::pmr::memory_resource front ends for detail::Arena, so standard pmr
+// containers and task::list<T, std::pmr::polymorphic_allocator<T>> can draw
+// from one arena without carrying its type around. Neither resource is
+// thread-safe, and both return every block to ::operator delete on
+// destruction, whether or not the memory was deallocated first.
+
+// Only ever bumps: deallocation is a no-op, so memory is reclaimed with the
+// resource. The cheapest choice for request-scoped object graphs that are
+// built, used and dropped as a whole.
+class MonotonicArenaResource : public std::pmr::memory_resource {
+public:
+    explicit MonotonicArenaResource(std::size_t first_block_size = detail::Arena::kFirstBlockSize)
+        : _arena(first_block_size) {}
+
+    MonotonicArenaResource(const MonotonicArenaResource&) = delete;
+    MonotonicArenaResource& operator=(const MonotonicArenaResource&) = delete;
+
+    const detail::Arena& arena() const noexcept { return _arena; }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        return _arena.bump(bytes, alignment);
+    }
+
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    detail::Arena _arena;
+};
+
+// Recycles small deallocated chunks through the arena's size-class free lists,
+// like CustomAllocator does, so long-lived containers with churn run in
+// bounded memory.
+class PooledArenaResource : public std::pmr::memory_resource {
+public:
+    explicit PooledArenaResource(std::size_t first_block_size = detail::Arena::kFirstBlockSize)
+        : _arena(first_block_size) {}
+
+    PooledArenaResource(const PooledArenaResource&) = delete;
+    PooledArenaResource& operator=(const PooledArenaResource&) = delete;
+
+    const detail::Arena& arena() const noexcept { return _arena; }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        return _arena.allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+        _arena.deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    detail::Arena _arena;
+};
@@ -0,0 +1,381 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "allocator.h"
+#include "shared_arena_allocator.h"
+
+#if defined(__clang__)
+#define ARENA_NO_SANITIZE_THREAD __attribute__((no_sanitize("thread"), noinline))
+#elif defined(__GNUC__)
+#define ARENA_NO_SANITIZE_THREAD __attribute__((no_sanitize_thread, noinline))
+#else
+#define ARENA_NO_SANITIZE_THREAD
+#endif
+
+namespace detail {
+
+// Treiber stack of free chunks. The head carries a 16-bit tag in the unused top
+// bits of the pointer, bumped on every change, so a pop that raced with a pop
+// and a push of the same chunk (ABA) fails its CAS. Chunks live in arena blocks
+// that are only freed with the whole arena, so reading the next pointer of a
+// chunk another thread has just taken is harmless.
+class TaggedFreeList {
+public:
+    struct Chunk {
+        std::atomic<Chunk*> next;
+    };
+
+    void push(Chunk* first, Chunk* last) noexcept {
+        std::uintptr_t head = _head.load(std::memory_order_relaxed);
+        do {
+            last->next.store(pointer(head), std::memory_order_relaxed);
+        } while (!_head.compare_exchange_weak(head, pack(first, head),
+                                              std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    Chunk* pop() noexcept {
+        std::uintptr_t head = _head.load(std::memory_order_acquire);
+        for (;;) {
+            Chunk* chunk = pointer(head);
+            if (chunk == nullptr)
+                return nullptr;
+            Chunk* next = peekNext(chunk);
+            if (_head.compare_exchange_weak(head, pack(next, head),
+                                            std::memory_order_acquire, std::memory_order_acquire))
+                return chunk;
+        }
+    }
+
+private:
+    // May race with the new owner of a chunk that was popped in between and is
+    // already being written to; the tag then fails the CAS and the value is
+    // dropped. Kept out of ThreadSanitizer's sight for that reason.
+    ARENA_NO_SANITIZE_THREAD
+    static Chunk* peekNext(Chunk* chunk) noexcept {
+#if defined(__GNUC__)
+        return __atomic_load_n(reinterpret_cast<Chunk**>(&chunk->next), __ATOMIC_RELAXED);
+#else
+        return chunk->next.load(std::memory_order_relaxed);
+#endif
+    }
+
+    static_assert(sizeof(void*) == 8, "the tag lives in the top 16 bits of a 64-bit pointer");
+    static constexpr int kTagShift = 48;
+    static constexpr std::uintptr_t kPointerMask = (std::uintptr_t(1) << kTagShift) - 1;
+
+    static Chunk* pointer(std::uintptr_t head) noexcept {
+        return reinterpret_cast<Chunk*>(head & kPointerMask);
+    }
+
+    // `chunk` with the tag of `old_head` plus one.
+    static std::uintptr_t pack(Chunk* chunk, std::uintptr_t old_head) noexcept {
+        std::uintptr_t tag = (old_head >> kTagShift) + 1;
+        return reinterpret_cast<std::uintptr_t>(chunk) | (tag << kTagShift);
+    }
+
+    std::atomic<std::uintptr_t> _head{0};
+};
+
+// Thread-safe counterpart of Arena with the same block growth and size classes.
+// Bumping is a CAS on the offset of the newest block; only opening a block takes
+// a lock. Freed small chunks go to one lock-free TaggedFreeList per size class.
+class ConcurrentArena {
+public:
+    using Chunk = TaggedFreeList::Chunk;
+
+    explicit ConcurrentArena(std::size_t first_block_size = Arena::kFirstBlockSize);
+    ConcurrentArena(const ConcurrentArena&) = delete;
+    ConcurrentArena& operator=(const ConcurrentArena&) = delete;
+    ~ConcurrentArena();
+
+    void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t));
+    void deallocate(void* p, std::size_t bytes, std::size_t alignment = alignof(std::max_align_t)) noexcept;
+
+    std::size_t capacity() const noexcept { return _capacity.load(std::memory_order_relaxed); }
+
+    // Size class plumbing shared with ThreadCachingArena.
+    static bool pooled(std::size_t bytes, std::size_t alignment) noexcept {
+        return bytes != 0 && bytes <= Arena::kMaxPooledSize && alignment <= Arena::kSizeClassStep;
+    }
+
+    static std::size_t sizeClass(std::size_t bytes) noexcept {
+        return (bytes - 1) / Arena::kSizeClassStep;
+    }
+
+    static std::size_t classSize(std::size_t size_class) noexcept {
+        return (size_class + 1) * Arena::kSizeClassStep;
+    }
+
+    static constexpr std::size_t kSizeClasses = Arena::kMaxPooledSize / Arena::kSizeClassStep;
+
+    TaggedFreeList& freeList(std::size_t size_class) noexcept { return _free[size_class]; }
+
+    void* bump(std::size_t bytes, std::size_t alignment);
+
+private:
+    struct alignas(std::max_align_t) Block {
+        Block* next;
+        std::size_t size;
+        std::atomic<std::size_t> used;
+
+        char* begin() { return reinterpret_cast<char*>(this + 1); }
+    };
+
+    // Opens a new block unless another thread already replaced `seen`.
+    void grow(Block* seen, std::size_t min_bytes);
+
+    TaggedFreeList _free[kSizeClasses];
+    std::atomic<Block*> _current{nullptr};
+    std::mutex _grow_mutex;
+    std::size_t _next_block_size;  // guarded by _grow_mutex
+    std::atomic<std::size_t> _capacity{0};
+};
+
+inline ConcurrentArena::ConcurrentArena(std::size_t first_block_size)
+    : _next_block_size(std::max<std::size_t>(first_block_size, 1)) {}
+
+inline ConcurrentArena::~ConcurrentArena() {
+    Block* block = _current.load(std::memory_order_relaxed);
+    while (block != nullptr) {
+        Block* next = block->next;
+        block->~Block();
+        ::operator delete(block);
+        block = next;
+    }
+}
+
+inline void* ConcurrentArena::allocate(std::size_t bytes, std::size_t alignment) {
+    if (!pooled(bytes, alignment))
+        return bump(bytes, alignment);
+    std::size_t size_class = sizeClass(bytes);
+    if (Chunk* chunk = _free[size_class].pop())
+        return chunk;
+    return bump(classSize(size_class), Arena::kSizeClassStep);
+}
+
+inline void ConcurrentArena::deallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept {
+    if (p == nullptr || !pooled(bytes, alignment))
+        return;
+    Chunk* chunk = ::new(p) Chunk{{nullptr}};
+    _free[sizeClass(bytes)].push(chunk, chunk);
+}
+
+inline void* ConcurrentArena::bump(std::size_t bytes, std::size_t alignment) {
+    for (;;) {
+        Block* block = _current.load(std::memory_order_acquire);
+        if (block != nullptr) {
+            auto base = reinterpret_cast<std::uintptr_t>(block->begin());
+            std::size_t used = block->used.load(std::memory_order_relaxed);
+            for (;;) {
+                std::size_t padding = -(base + used) & (alignment - 1);
+                if (block->size - used < padding || block->size - used - padding < bytes)
+                    break;
+                if (block->used.compare_exchange_weak(used, used + padding + bytes, std::memory_order_relaxed))
+                    return block->begin() + used + padding;
+            }
+        }
+        std::size_t slack = alignment > alignof(Block) ? alignment - alignof(Block) : 0;
+        if (bytes > std::numeric_limits<std::size_t>::max() - sizeof(Block) - slack)
+            throw std::bad_alloc();
+        grow(block, bytes + slack);
+    }
+}
+
+inline void ConcurrentArena::grow(Block* seen, std::size_t min_bytes) {
+    std::lock_guard<std::mutex> lock(_grow_mutex);
+    if (_current.load(std::memory_order_relaxed) != seen)
+        return;
+    std::size_t size = std::max(_next_block_size, min_bytes);
+    void* memory = ::operator new(sizeof(Block) + size);
+    Block* block = ::new(memory) Block{seen, size, {0}};
+    _current.store(block, std::memory_order_release);
+    _capacity.fetch_add(sizeof(Block) + size, std::memory_order_relaxed);
+    _next_block_size = std::min(_next_block_size * 2, std::max(Arena::kMaxBlockSize, _next_block_size));
+}
+
+// ConcurrentArena with a per-thread cache in front of it. Every thread keeps a
+// magazine of free chunks per size class and serves small requests from it
+// without any atomic operation. An empty magazine is refilled with half a
+// magazine from the shared free list or with one bump of the shared arena; a
+// full one returns half of its chunks to the shared free list in one push.
+//
+// Chunks freed by another thread land in that thread's magazine. Magazines of
+// a thread that exits go back to the shared free list; those of an arena that
+// is destroyed first are simply forgotten, the memory goes with the arena.
+class ThreadCachingArena {
+public:
+    static constexpr std::size_t kMagazineSize = 64;
+
+    explicit ThreadCachingArena(std::size_t first_block_size = Arena::kFirstBlockSize)
+        : _shared(std::make_shared<ConcurrentArena>(first_block_size)), _id(nextId()) {}
+    ThreadCachingArena(const ThreadCachingArena&) = delete;
+    ThreadCachingArena& operator=(const ThreadCachingArena&) = delete;
+    ~ThreadCachingArena() { Caches::local().forget(_id); }
+
+    void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t));
+    void deallocate(void* p, std::size_t bytes, std::size_t alignment = alignof(std::max_align_t)) noexcept;
+
+    std::size_t capacity() const noexcept { return _shared->capacity(); }
+
+private:
+    using Chunk = ConcurrentArena::Chunk;
+
+    struct Magazine {
+        std::size_t count = 0;
+        void* chunks[kMagazineSize];
+    };
+
+    struct Cache {
+        std::weak_ptr<ConcurrentArena> shared;
+        std::uint64_t id;
+        Magazine magazines[ConcurrentArena::kSizeClasses];
+
+        // Hands `count` chunks from the top of `magazine` back to the shared arena.
+        static void flush(ConcurrentArena& shared, std::size_t size_class, Magazine& magazine, std::size_t count);
+        ~Cache();
+    };
+
+    // The caches of the calling thread, one per arena it has touched.
+    class Caches {
+    public:
+        static Caches& local() {
+            static thread_local Caches caches;
+            return caches;
+        }
+
+        Cache& find(const std::shared_ptr<ConcurrentArena>& shared, std::uint64_t id);
+        void forget(std::uint64_t id) noexcept;
+
+    private:
+        std::vector<std::unique_ptr<Cache>> _caches;
+        Cache* _last = nullptr;
+    };
+
+    static std::uint64_t nextId() {
+        static std::atomic<std::uint64_t> id{0};
+        return id.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void refill(std::size_t size_class, Magazine& magazine);
+
+    std::shared_ptr<ConcurrentArena> _shared;
+    std::uint64_t _id;
+};
+
+inline void* ThreadCachingArena::allocate(std::size_t bytes, std::size_t alignment) {
+    if (!ConcurrentArena::pooled(bytes, alignment))
+        return _shared->bump(bytes, alignment);
+    std::size_t size_class = ConcurrentArena::sizeClass(bytes);
+    Magazine& magazine = Caches::local().find(_shared, _id).magazines[size_class];
+    if (magazine.count == 0)
+        refill(size_class, magazine);
+    return magazine.chunks[--magazine.count];
+}
+
+inline void ThreadCachingArena::deallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept {
+    if (p == nullptr || !ConcurrentArena::pooled(bytes, alignment))
+        return;
+    std::size_t size_class = ConcurrentArena::sizeClass(bytes);
+    Cache* cache;
+    try {
+        cache = &Caches::local().find(_shared, _id);
+    } catch (const std::bad_alloc&) {
+        _shared->deallocate(p, bytes, alignment);
+        return;
+    }
+    Magazine& magazine = cache->magazines[size_class];
+    if (magazine.count == kMagazineSize)
+        Cache::flush(*_shared, size_class, magazine, kMagazineSize / 2);
+    magazine.chunks[magazine.count++] = p;
+}
+
+inline void ThreadCachingArena::refill(std::size_t size_class, Magazine& magazine) {
+    const std::size_t batch = kMagazineSize / 2;
+    TaggedFreeList& free_list = _shared->freeList(size_class);
+    while (magazine.count < batch) {
+        Chunk* chunk = free_list.pop();
+        if (chunk == nullptr)
+            break;
+        magazine.chunks[magazine.count++] = chunk;
+    }
+    if (magazine.count != 0)
+        return;
+
+    std::size_t size = ConcurrentArena::classSize(size_class);
+    char* run = static_cast<char*>(_shared->bump(size * batch, Arena::kSizeClassStep));
+    for (std::size_t i = batch; i-- > 0;)
+        magazine.chunks[magazine.count++] = run + i * size;
+}
+
+inline void ThreadCachingArena::Cache::flush(ConcurrentArena& shared, std::size_t size_class,
+                                             Magazine& magazine, std::size_t count) {
+    if (count == 0)
+        return;
+    Chunk* first = nullptr;
+    Chunk* last = nullptr;
+    for (std::size_t i = 0; i < count; i++) {
+        Chunk* chunk = ::new(magazine.chunks[--magazine.count]) Chunk{{first}};
+        if (last == nullptr)
+            last = chunk;
+        first = chunk;
+    }
+    shared.freeList(size_class).push(first, last);
+}
+
+inline ThreadCachingArena::Cache::~Cache() {
+    if (std::shared_ptr<ConcurrentArena> arena = shared.lock()) {
+        for (std::size_t size_class = 0; size_class < ConcurrentArena::kSizeClasses; size_class++)
+            flush(*arena, size_class, magazines[size_class], magazines[size_class].count);
+    }
+}
+
+inline ThreadCachingArena::Cache& ThreadCachingArena::Caches::find(
+        const std::shared_ptr<ConcurrentArena>& shared, std::uint64_t id) {
+    if (_last != nullptr && _last->id == id)
+        return *_last;
+    for (const std::unique_ptr<Cache>& cache : _caches) {
+        if (cache->id == id)
+            return *(_last = cache.get());
+    }
+
+    // Caches of arenas that are gone are dead weight by now.
+    _caches.erase(std::remove_if(_caches.begin(), _caches.end(),
+                                 [](const std::unique_ptr<Cache>& cache) { return cache->shared.expired(); }),
+                  _caches.end());
+    std::unique_ptr<Cache> cache(new Cache{shared, id, {}});
+    _caches.push_back(std::move(cache));
+    return *(_last = _caches.back().get());
+}
+
+inline void ThreadCachingArena::Caches::forget(std::uint64_t id) noexcept {
+    for (auto it = _caches.begin(); it != _caches.end(); ++it) {
+        if ((*it)->id == id) {
+            // The arena is going away, there is nothing to flush into.
+            (*it)->shared.reset();
+            if (_last == it->get())
+                _last = nullptr;
+            _caches.erase(it);
+            return;
+        }
+    }
+}
+
+}  // namespace detail
+
+// Any number of threads may allocate and free through copies of one allocator.
+template <typename T>
+using ConcurrentAllocator = SharedArenaAllocator<T, detail::ConcurrentArena>;
+
+// Same, with per-thread magazines for multi-threaded container workloads.
+template <typename T>
+using ThreadCachingAllocator = SharedArenaAllocator<T, detail::ThreadCachingArena>;
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "allocator.h"
+#include "shared_arena_allocator.h"
+
+namespace detail {
+
+// Linux 5.14+, older headers may not know it yet.
+#ifdef MADV_POPULATE_WRITE
+constexpr int kMadvPopulateWrite = MADV_POPULATE_WRITE;
+#else
+constexpr int kMadvPopulateWrite = 23;
+#endif
+
+// Block source over ranges of virtual memory, for arenas that grow to many
+// gigabytes. A range is reserved without backing, and regions are committed
+// (made readable and writable) at its front as the arena asks for them, so
+// successive regions are adjacent and the arena never leaves the tail of a
+// block unused. Once a range is used up, another one twice its size is
+// reserved after it; only the first `reservation` bytes are reserved up front.
+//
+// Ranges are aligned to kHugePageSize and committed regions are rounded up to
+// it, with transparent huge pages requested for each, which cuts the page
+// table and the TLB footprint of a large arena by a factor of 512. With
+// `prefault` every region is populated when committed rather than on first
+// touch, trading commit latency for a fault-free fast path.
+class MappedBlocks {
+public:
+    static constexpr std::size_t kHugePageSize = std::size_t(1) << 21;
+    static constexpr std::size_t kDefaultReservation = std::size_t(1) << 28;
+
+    explicit MappedBlocks(std::size_t reservation = kDefaultReservation, bool prefault = false);
+    MappedBlocks(MappedBlocks&& other) noexcept;
+    MappedBlocks& operator=(MappedBlocks&&) = delete;
+    ~MappedBlocks();
+
+    Region obtain(std::size_t min_bytes);
+
+    struct Position {
+        std::size_t committed;
+        std::size_t regions;
+    };
+
+    Position position() const noexcept { return {_committed, _regions}; }
+    // Decommits everything past `position`, handing the pages back to the OS,
+    // and releases the ranges reserved after it.
+    void rewind(Position position) noexcept;
+
+    // Committed bytes.
+    std::size_t capacity() const noexcept { return _committed; }
+    std::size_t blockCount() const noexcept { return _regions; }
+    // Reserved bytes, over all ranges.
+    std::size_t reservation() const noexcept;
+    std::size_t rangeCount() const noexcept { return _ranges.size(); }
+
+private:
+    struct Range {
+        void* mapping;
+        std::size_t mapping_size;
+        char* base;
+        std::size_t size;
+        std::size_t committed;
+    };
+
+    static std::size_t roundUp(std::size_t bytes) noexcept {
+        return (std::max<std::size_t>(bytes, 1) + kHugePageSize - 1) & ~(kHugePageSize - 1);
+    }
+
+    static std::size_t doubled(std::size_t size) noexcept {
+        return size > std::numeric_limits<std::size_t>::max() / 2 ? size : size * 2;
+    }
+
+    void reserve(std::size_t size);
+
+    std::vector<Range> _ranges;
+    std::size_t _next_range_size = 0;
+    std::size_t _committed = 0;
+    std::size_t _regions = 0;
+    bool _prefault;
+};
+
+inline MappedBlocks::MappedBlocks(std::size_t reservation, bool prefault) : _prefault(prefault) {
+    reserve(roundUp(reservation));
+}
+
+inline MappedBlocks::MappedBlocks(MappedBlocks&& other) noexcept
+    : _ranges(std::move(other._ranges)), _next_range_size(other._next_range_size),
+      _committed(other._committed), _regions(other._regions), _prefault(other._prefault) {
+    other._ranges.clear();
+    other._committed = 0;
+    other._regions = 0;
+}
+
+inline MappedBlocks::~MappedBlocks() {
+    for (const Range& range : _ranges)
+        ::munmap(range.mapping, range.mapping_size);
+}
+
+inline void MappedBlocks::reserve(std::size_t size) {
+    _ranges.reserve(_ranges.size() + 1);
+    // One extra huge page of slack to align the base.
+    std::size_t mapping_size = size + kHugePageSize;
+    void* mapping = ::mmap(nullptr, mapping_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mapping == MAP_FAILED)
+        throw std::bad_alloc();
+    auto address = reinterpret_cast<std::uintptr_t>(mapping);
+    char* base = reinterpret_cast<char*>((address + kHugePageSize - 1) & ~(kHugePageSize - 1));
+    _ranges.push_back({mapping, mapping_size, base, size, 0});
+    _next_range_size = doubled(size);
+}
+
+inline Region MappedBlocks::obtain(std::size_t min_bytes) {
+    if (min_bytes > std::numeric_limits<std::size_t>::max() - kHugePageSize)
+        throw std::bad_alloc();
+    if (min_bytes > _ranges.back().size - _ranges.back().committed)
+        reserve(std::max(_next_range_size, roundUp(min_bytes)));
+    Range& range = _ranges.back();
+    std::size_t size = std::min(roundUp(min_bytes), range.size - range.committed);
+    char* begin = range.base + range.committed;
+    if (::mprotect(begin, size, PROT_READ | PROT_WRITE) != 0)
+        throw std::bad_alloc();
+    // Both are hints: without THP or MADV_POPULATE_WRITE support the memory is
+    // still there, just in small pages or faulted in on first touch.
+    ::madvise(begin, size, MADV_HUGEPAGE);
+    if (_prefault && ::madvise(begin, size, kMadvPopulateWrite) != 0) {
+        const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        for (std::size_t offset = 0; offset < size; offset += page)
+            static_cast<volatile char*>(begin)[offset] = 0;
+    }
+    range.committed += size;
+    _committed += size;
+    ++_regions;
+    return {begin, size};
+}
+
+inline void MappedBlocks::rewind(Position position) noexcept {
+    // Ranges past the first that hold nothing before the position go entirely.
+    while (_ranges.size() > 1 && _committed - _ranges.back().committed >= position.committed) {
+        _committed -= _ranges.back().committed;
+        ::munmap(_ranges.back().mapping, _ranges.back().mapping_size);
+        _ranges.pop_back();
+    }
+    Range& range = _ranges.back();
+    std::size_t keep = range.committed - (_committed - position.committed);
+    if (keep < range.committed) {
+        // Mapping fresh PROT_NONE pages over the range drops its contents.
+        ::mmap(range.base + keep, range.committed - keep, PROT_NONE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+    }
+    range.committed = keep;
+    _committed = position.committed;
+    _regions = position.regions;
+    _next_range_size = doubled(range.size);
+}
+
+inline std::size_t MappedBlocks::reservation() const noexcept {
+    std::size_t total = 0;
+    for (const Range& range : _ranges)
+        total += range.size;
+    return total;
+}
+
+using MappedArena = BasicArena<MappedBlocks>;
+
+}  // namespace detail
+
+// CustomAllocator's interface over an arena in one mmap'ed reservation with
+// transparent huge pages. Copies and rebinds share the arena; not thread-safe.
+//
+//   auto arena = std::make_shared<detail::MappedArena>(
+//       detail::MappedBlocks::kHugePageSize, detail::MappedBlocks(std::size_t(1) << 34, true));
+//   task::list<int, MappedAllocator<int>> list{MappedAllocator<int>(arena)};
+template <typename T>
+using MappedAllocator = SharedArenaAllocator<T, detail::MappedArena>;
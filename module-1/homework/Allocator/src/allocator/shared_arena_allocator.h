@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Allocator interface of CustomAllocator over any arena type with
+// allocate(bytes, alignment) and deallocate(p, bytes, alignment), shared by
+// all copies and rebinds. Copies may be used from different threads exactly
+// when SharedArena itself is thread-safe.
+template <typename T, typename SharedArena>
+class SharedArenaAllocator {
+public:
+    template <typename U>
+    struct rebind {  // NOLINT
+        using other = SharedArenaAllocator<U, SharedArena>;
+    };
+
+    using value_type = T;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using reference = T&;
+    using const_reference = const T&;
+    using size_type = std::size_t;
+    using pointer_difference = std::ptrdiff_t;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    SharedArenaAllocator() : _arena(std::make_shared<SharedArena>()) {}
+
+    // Declared so that there are no implicit moves: a moved-from allocator
+    // must still equal the new one, so moves share the arena like copies do.
+    SharedArenaAllocator(const SharedArenaAllocator&) noexcept = default;
+    SharedArenaAllocator& operator=(const SharedArenaAllocator&) noexcept = default;
+
+    // Shares an arena built with non-default parameters.
+    explicit SharedArenaAllocator(std::shared_ptr<SharedArena> arena) noexcept : _arena(std::move(arena)) {}
+
+    template <typename U>
+    SharedArenaAllocator(const SharedArenaAllocator<U, SharedArena>& other) noexcept
+        : _arena(other._arena) {}
+
+    pointer allocate(size_type n) {
+        if (n > max_size())
+            throw std::bad_alloc();
+        return static_cast<pointer>(_arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(pointer p, size_type n) noexcept {
+        _arena->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    template <typename... Args>
+    void construct(pointer p, Args&&... args) noexcept(std::is_nothrow_constructible_v<value_type, Args...>) {
+        ::new((void *)p) T(std::forward<Args>(args)...);
+    }
+
+    void destroy(pointer p) noexcept(std::is_nothrow_destructible_v<value_type>) {
+        p->~T();
+    }
+
+    size_type max_size() const noexcept {
+        return std::numeric_limits<size_type>::max() / sizeof(T);
+    }
+
+    const SharedArena& arena() const noexcept { return *_arena; }
+
+    template <typename U>
+    bool operator==(const SharedArenaAllocator<U, SharedArena>& other) const noexcept {
+        return _arena == other._arena;
+    }
+
+    template <typename U>
+    bool operator!=(const SharedArenaAllocator<U, SharedArena>& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    template <typename U, typename OtherArena>
+    friend class SharedArenaAllocator;
+
+    std::shared_ptr<SharedArena> _arena;
+};
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Inline buffer of N bytes for ShortAllocator, meant to live on the stack next
+// to the containers that use it:
+//
+//   StackArena<1024> arena;
+//   task::list<int, ShortAllocator<int, 1024>> list{ShortAllocator<int, 1024>(arena)};
+//
+// Allocations bump a cursor through the buffer. Once it is full, requests go
+// to ::operator new instead, so the buffer only bounds what is served without
+// the heap, not the container size. Freeing the most recent allocation in the
+// buffer gives its bytes back; anything else in the buffer is reclaimed when
+// the arena goes away. That suits small, short-lived containers: a list that
+// is built and dropped never touches the heap, while one with a long history
+// of erases eventually spills.
+//
+// The arena must outlive every allocator and container that uses it, and it
+// can be neither copied nor moved.
+template <std::size_t N>
+class StackArena {
+public:
+    static constexpr std::size_t kAlignment = alignof(std::max_align_t);
+
+    StackArena() noexcept : _cursor(_buffer) {}
+    StackArena(const StackArena&) = delete;
+    StackArena& operator=(const StackArena&) = delete;
+
+    // `alignment` must be a power of two.
+    void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t));
+
+    // `bytes` and `alignment` must be the ones `p` was allocated with.
+    void deallocate(void* p, std::size_t bytes, std::size_t alignment = alignof(std::max_align_t)) noexcept;
+
+    static constexpr std::size_t size() noexcept { return N; }
+    std::size_t used() const noexcept { return static_cast<std::size_t>(_cursor - _buffer); }
+    // Requests that did not fit and went to ::operator new.
+    std::size_t spills() const noexcept { return _spills; }
+
+    bool owns(const void* p) const noexcept {
+        auto address = reinterpret_cast<std::uintptr_t>(p);
+        return address >= reinterpret_cast<std::uintptr_t>(_buffer) &&
+               address < reinterpret_cast<std::uintptr_t>(_buffer + N);
+    }
+
+private:
+    alignas(kAlignment) std::byte _buffer[N];
+    std::byte* _cursor;
+    std::size_t _spills = 0;
+};
+
+template <std::size_t N>
+void* StackArena<N>::allocate(std::size_t bytes, std::size_t alignment) {
+    std::size_t padding = -reinterpret_cast<std::uintptr_t>(_cursor) & (alignment - 1);
+    std::size_t left = static_cast<std::size_t>(_buffer + N - _cursor);
+    if (padding <= left && bytes <= left - padding) {
+        void* result = _cursor + padding;
+        _cursor += padding + bytes;
+        return result;
+    }
+    ++_spills;
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+        return ::operator new(bytes, std::align_val_t(alignment));
+    return ::operator new(bytes);
+}
+
+template <std::size_t N>
+void StackArena<N>::deallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept {
+    if (p == nullptr)
+        return;
+    if (owns(p)) {
+        auto* begin = static_cast<std::byte*>(p);
+        if (begin + bytes == _cursor)
+            _cursor = begin;
+        return;
+    }
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+        ::operator delete(p, bytes, std::align_val_t(alignment));
+    else
+        ::operator delete(p, bytes);
+}
+
+// Allocator interface of CustomAllocator over a StackArena<N>. Copies and
+// rebinds refer to the same arena; there is no default constructor because
+// there is no buffer to default to. Not thread-safe.
+template <typename T, std::size_t N>
+class ShortAllocator {
+public:
+    template <typename U>
+    struct rebind {  // NOLINT
+        using other = ShortAllocator<U, N>;
+    };
+
+    using value_type = T;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using reference = T&;
+    using const_reference = const T&;
+    using size_type = std::size_t;
+    using pointer_difference = std::ptrdiff_t;
+    // Memory stays with the arena of the scope that allocated it.
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_swap = std::false_type;
+    using is_always_equal = std::false_type;
+
+    explicit ShortAllocator(StackArena<N>& arena) noexcept : _arena(&arena) {}
+
+    template <typename U>
+    ShortAllocator(const ShortAllocator<U, N>& other) noexcept : _arena(other._arena) {}
+
+    pointer allocate(size_type n) {
+        if (n > max_size())
+            throw std::bad_alloc();
+        return static_cast<pointer>(_arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(pointer p, size_type n) noexcept {
+        _arena->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    template <typename... Args>
+    void construct(pointer p, Args&&... args) noexcept(std::is_nothrow_constructible_v<value_type, Args...>) {
+        ::new((void *)p) T(std::forward<Args>(args)...);
+    }
+
+    void destroy(pointer p) noexcept(std::is_nothrow_destructible_v<value_type>) {
+        p->~T();
+    }
+
+    size_type max_size() const noexcept {
+        return std::numeric_limits<size_type>::max() / sizeof(T);
+    }
+
+    const StackArena<N>& arena() const noexcept { return *_arena; }
+
+    template <typename U>
+    bool operator==(const ShortAllocator<U, N>& other) const noexcept {
+        return _arena == other._arena;
+    }
+
+    template <typename U>
+    bool operator!=(const ShortAllocator<U, N>& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    template <typename U, std::size_t M>
+    friend class ShortAllocator;
+
+    StackArena<N>* _arena;
+};
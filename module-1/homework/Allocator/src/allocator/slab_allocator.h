@@ -0,0 +1,161 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <new>
+
+#include "shared_arena_allocator.h"
+
+namespace detail {
+
+// Segregated slab heap for small objects of many different sizes.
+//
+// Requests up to kMaxSlabObject bytes are rounded up to one of kClassSizes,
+// powers of two and the midpoints between them, so requests above 32 bytes
+// lose less than a third of their object to rounding. Every size class owns
+// its own chain of slabs, each carved into equal objects, and an intrusive
+// free list of objects given back. Both allocate and deallocate are a table
+// lookup plus a list push or pop. Slabs are only released with the heap.
+//
+// Larger or over-aligned requests go straight to ::operator new and back to
+// ::operator delete on deallocate, so the heap never holds on to big buffers.
+class SlabHeap {
+public:
+    static constexpr std::size_t kClassCount = 14;
+    static constexpr std::array<std::size_t, kClassCount> kClassSizes = {
+        16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048};
+    static constexpr std::size_t kMaxSlabObject = kClassSizes[kClassCount - 1];
+    static constexpr std::size_t kAlignment = alignof(std::max_align_t);
+    static constexpr std::size_t kSlabSize = 1 << 16;
+
+    SlabHeap() = default;
+    SlabHeap(const SlabHeap&) = delete;
+    SlabHeap& operator=(const SlabHeap&) = delete;
+    ~SlabHeap();
+
+    // `alignment` must be a power of two.
+    void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t));
+
+    // `bytes` and `alignment` must be the ones `p` was allocated with.
+    void deallocate(void* p, std::size_t bytes, std::size_t alignment = alignof(std::max_align_t)) noexcept;
+
+    // Bytes held in slabs, headers included; forwarded requests do not count.
+    std::size_t capacity() const noexcept { return _capacity; }
+    std::size_t slabCount(std::size_t size_class) const noexcept;
+
+    static bool slabbed(std::size_t bytes, std::size_t alignment) noexcept {
+        return bytes <= kMaxSlabObject && alignment <= kAlignment;
+    }
+
+    static std::size_t sizeClass(std::size_t bytes) noexcept {
+        return kClassOf[bytes == 0 ? 0 : (bytes - 1) / kAlignment];
+    }
+
+private:
+    struct alignas(std::max_align_t) Slab {
+        Slab* next;
+
+        char* begin() { return reinterpret_cast<char*>(this + 1); }
+    };
+
+    struct FreeObject {
+        FreeObject* next;
+    };
+
+    struct SizeClass {
+        FreeObject* free = nullptr;
+        Slab* slabs = nullptr;
+        char* cursor = nullptr;
+        char* end = nullptr;
+    };
+
+    // Size class of every kAlignment-sized step up to kMaxSlabObject.
+    using ClassTable = std::array<unsigned char, kMaxSlabObject / kAlignment>;
+
+    static constexpr ClassTable classTable() {
+        ClassTable table{};
+        std::size_t size_class = 0;
+        for (std::size_t step = 0; step < table.size(); step++) {
+            while (kClassSizes[size_class] < (step + 1) * kAlignment)
+                size_class++;
+            table[step] = static_cast<unsigned char>(size_class);
+        }
+        return table;
+    }
+
+    static const ClassTable kClassOf;
+
+    void* carve(std::size_t size_class);
+
+    std::array<SizeClass, kClassCount> _classes{};
+    std::size_t _capacity = 0;
+};
+
+constexpr SlabHeap::ClassTable SlabHeap::kClassOf = SlabHeap::classTable();
+
+inline SlabHeap::~SlabHeap() {
+    for (SizeClass& size_class : _classes) {
+        while (size_class.slabs != nullptr) {
+            Slab* next = size_class.slabs->next;
+            ::operator delete(size_class.slabs);
+            size_class.slabs = next;
+        }
+    }
+}
+
+inline void* SlabHeap::allocate(std::size_t bytes, std::size_t alignment) {
+    if (!slabbed(bytes, alignment)) {
+        if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            return ::operator new(bytes, std::align_val_t(alignment));
+        return ::operator new(bytes);
+    }
+    std::size_t size_class = sizeClass(bytes);
+    if (FreeObject* object = _classes[size_class].free) {
+        _classes[size_class].free = object->next;
+        return object;
+    }
+    return carve(size_class);
+}
+
+inline void SlabHeap::deallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept {
+    if (p == nullptr)
+        return;
+    if (!slabbed(bytes, alignment)) {
+        if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            ::operator delete(p, bytes, std::align_val_t(alignment));
+        else
+            ::operator delete(p, bytes);
+        return;
+    }
+    SizeClass& size_class = _classes[sizeClass(bytes)];
+    size_class.free = ::new(p) FreeObject{size_class.free};
+}
+
+inline std::size_t SlabHeap::slabCount(std::size_t size_class) const noexcept {
+    std::size_t count = 0;
+    for (Slab* slab = _classes[size_class].slabs; slab != nullptr; slab = slab->next)
+        ++count;
+    return count;
+}
+
+inline void* SlabHeap::carve(std::size_t size_class) {
+    SizeClass& state = _classes[size_class];
+    std::size_t object_size = kClassSizes[size_class];
+    if (static_cast<std::size_t>(state.end - state.cursor) < object_size) {
+        void* memory = ::operator new(sizeof(Slab) + kSlabSize);
+        state.slabs = ::new(memory) Slab{state.slabs};
+        state.cursor = state.slabs->begin();
+        state.end = state.cursor + kSlabSize;
+        _capacity += sizeof(Slab) + kSlabSize;
+    }
+    void* result = state.cursor;
+    state.cursor += object_size;
+    return result;
+}
+
+}  // namespace detail
+
+// Small objects of any size from per-size-class slabs shared by all copies and
+// rebinds of the allocator; big ones from ::operator new. Not thread-safe.
+template <typename T>
+using SlabAllocator = SharedArenaAllocator<T, detail::SlabHeap>;
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+// Build with -DALLOCATOR_STATS=0 to compile the bookkeeping of every
+// StatsAllocator out; it then costs exactly as much as the allocator it wraps.
+#ifndef ALLOCATOR_STATS
+#define ALLOCATOR_STATS 1
+#endif
+
+// What a StatsAllocator and all of its copies and rebinds have seen.
+struct AllocationStats {
+    static constexpr std::size_t kBuckets = 48;
+
+    std::size_t allocations = 0;
+    std::size_t deallocations = 0;
+    std::size_t bytes_allocated = 0;
+    std::size_t bytes_deallocated = 0;
+    std::size_t live_bytes = 0;
+    std::size_t peak_bytes = 0;
+
+    // Bucket i counts requests of [2^i, 2^(i+1)) bytes, bucket 0 includes 0.
+    std::array<std::size_t, kBuckets> size_histogram{};
+    // Bucket i counts blocks freed [2^i, 2^(i+1)) nanoseconds after they were
+    // allocated, bucket 0 includes 0.
+    std::array<std::size_t, kBuckets> lifetime_histogram{};
+
+    static std::size_t bucket(std::uint64_t value) noexcept {
+        std::size_t bucket = 0;
+        while (value > 1 && bucket + 1 < kBuckets) {
+            value >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    // Totals and the non-empty histogram buckets in a human-readable form.
+    void report(std::ostream& out) const;
+};
+
+inline void AllocationStats::report(std::ostream& out) const {
+    out << "allocations:   " << allocations << " (" << bytes_allocated << " bytes)\n"
+        << "deallocations: " << deallocations << " (" << bytes_deallocated << " bytes)\n"
+        << "live bytes:    " << live_bytes << "\n"
+        << "peak bytes:    " << peak_bytes << "\n";
+
+    auto print = [&out](const char* title, const char* unit, const std::array<std::size_t, kBuckets>& histogram) {
+        out << title << "\n";
+        for (std::size_t i = 0; i < kBuckets; i++) {
+            if (histogram[i] != 0) {
+                out << "  [" << (i == 0 ? 0 : std::uint64_t(1) << i) << ", " << (std::uint64_t(1) << (i + 1))
+                    << ") " << unit << ": " << histogram[i] << "\n";
+            }
+        }
+    };
+    print("request sizes:", "bytes", size_histogram);
+    print("lifetimes:", "ns", lifetime_histogram);
+}
+
+namespace detail {
+
+constexpr bool kAllocatorStatsEnabled = ALLOCATOR_STATS != 0;
+
+class StatsRecorder {
+public:
+    void allocated(void* p, std::size_t bytes) {
+        // Reserve the slot first so a throwing insert leaves the counters alone.
+        _births[p] = std::chrono::steady_clock::now();
+        _stats.allocations++;
+        _stats.bytes_allocated += bytes;
+        _stats.live_bytes += bytes;
+        _stats.peak_bytes = std::max(_stats.peak_bytes, _stats.live_bytes);
+        _stats.size_histogram[AllocationStats::bucket(bytes)]++;
+    }
+
+    void deallocated(void* p, std::size_t bytes) noexcept {
+        _stats.deallocations++;
+        _stats.bytes_deallocated += bytes;
+        _stats.live_bytes -= bytes;
+        auto birth = _births.find(p);
+        if (birth == _births.end())
+            return;
+        auto lifetime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - birth->second);
+        _stats.lifetime_histogram[AllocationStats::bucket(lifetime.count())]++;
+        _births.erase(birth);
+    }
+
+    const AllocationStats& stats() const noexcept { return _stats; }
+
+private:
+    AllocationStats _stats;
+    std::unordered_map<void*, std::chrono::steady_clock::time_point> _births;
+};
+
+// The recorder is a base rather than a member so that with statistics off it
+// takes no room at all.
+template <bool Enabled>
+class StatsHolder {
+protected:
+    StatsHolder() : _recorder(std::make_shared<StatsRecorder>()) {}
+    StatsRecorder* recorder() const noexcept { return _recorder.get(); }
+
+private:
+    std::shared_ptr<StatsRecorder> _recorder;
+};
+
+template <>
+class StatsHolder<false> {
+protected:
+    StatsRecorder* recorder() const noexcept { return nullptr; }
+};
+
+}  // namespace detail
+
+// Wraps any allocator and records what goes through it: counts, bytes, peak
+// usage and histograms of request sizes and lifetimes. Copies and rebinds
+// report into the same AllocationStats, so a container's node and value
+// allocations add up. Not thread-safe, like the allocators it is meant for.
+//
+// With Enabled false (the default under ALLOCATOR_STATS=0) nothing is
+// recorded, stats() stays empty and the wrapper has the size of Inner.
+template <typename Inner, bool Enabled = detail::kAllocatorStatsEnabled>
+class StatsAllocator : private detail::StatsHolder<Enabled> {
+    using inner_traits = std::allocator_traits<Inner>;
+
+public:
+    template <typename U>
+    struct rebind {  // NOLINT
+        using other = StatsAllocator<typename inner_traits::template rebind_alloc<U>, Enabled>;
+    };
+
+    using value_type = typename inner_traits::value_type;
+    using pointer = typename inner_traits::pointer;
+    using const_pointer = typename inner_traits::const_pointer;
+    using size_type = typename inner_traits::size_type;
+    using difference_type = typename inner_traits::difference_type;
+    using propagate_on_container_copy_assignment = typename inner_traits::propagate_on_container_copy_assignment;
+    using propagate_on_container_move_assignment = typename inner_traits::propagate_on_container_move_assignment;
+    using propagate_on_container_swap = typename inner_traits::propagate_on_container_swap;
+    // Separately constructed wrappers keep separate stats.
+    using is_always_equal = std::bool_constant<!Enabled && inner_traits::is_always_equal::value>;
+
+    StatsAllocator() = default;
+    explicit StatsAllocator(const Inner& inner) : _inner(inner) {}
+
+    // Declared so that there are no implicit moves: a moved-from allocator
+    // must still equal the new one and report into the same stats.
+    StatsAllocator(const StatsAllocator&) = default;
+    StatsAllocator& operator=(const StatsAllocator&) = default;
+
+    template <typename U>
+    StatsAllocator(const StatsAllocator<U, Enabled>& other) noexcept
+        : detail::StatsHolder<Enabled>(other), _inner(other._inner) {}
+
+    pointer allocate(size_type n) {
+        pointer p = inner_traits::allocate(_inner, n);
+        if constexpr (Enabled) {
+            // Some allocators return null for n == 0; there is nothing to record.
+            if (p == nullptr)
+                return p;
+            try {
+                this->recorder()->allocated(std::addressof(*p), n * sizeof(value_type));
+            } catch (...) {
+                inner_traits::deallocate(_inner, p, n);
+                throw;
+            }
+        }
+        return p;
+    }
+
+    void deallocate(pointer p, size_type n) {
+        if constexpr (Enabled) {
+            if (p != nullptr)
+                this->recorder()->deallocated(std::addressof(*p), n * sizeof(value_type));
+        }
+        inner_traits::deallocate(_inner, p, n);
+    }
+
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args) {
+        inner_traits::construct(_inner, p, std::forward<Args>(args)...);
+    }
+
+    template <typename U>
+    void destroy(U* p) {
+        inner_traits::destroy(_inner, p);
+    }
+
+    size_type max_size() const noexcept { return inner_traits::max_size(_inner); }
+
+    StatsAllocator select_on_container_copy_construction() const {
+        StatsAllocator copy(*this);
+        copy._inner = inner_traits::select_on_container_copy_construction(_inner);
+        return copy;
+    }
+
+    const Inner& inner() const noexcept { return _inner; }
+
+    const AllocationStats& stats() const noexcept {
+        if constexpr (Enabled) {
+            return this->recorder()->stats();
+        } else {
+            static const AllocationStats empty;
+            return empty;
+        }
+    }
+
+    void report(std::ostream& out) const {
+        if constexpr (Enabled)
+            stats().report(out);
+        else
+            out << "allocation statistics are disabled\n";
+    }
+
+    // Memory is interchangeable when it is for the wrapped allocators and it
+    // is accounted in the same stats, or else a block allocated through one
+    // would be deallocated through the other.
+    template <typename U>
+    bool operator==(const StatsAllocator<U, Enabled>& other) const noexcept {
+        return _inner == other._inner && this->recorder() == other.recorder();
+    }
+
+    template <typename U>
+    bool operator!=(const StatsAllocator<U, Enabled>& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    template <typename U, bool OtherEnabled>
+    friend class StatsAllocator;
+
+    Inner _inner;
+};
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <functional>
 #include <list>
 #include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
 #include <type_traits>
+#include <utility>
 
 namespace task {
 
@@ -11,7 +16,8 @@ class list {
 public:
     class iterator;
 private:
-    class Node;
+    struct NodeBase;
+    struct Node;
 
 public:
     using value_type = T;
@@ -33,7 +39,7 @@ public:
         using iterator_category = std::bidirectional_iterator_tag;
         using difference_type = std::ptrdiff_t;
 
-        explicit iterator(Node* ptr): _ptr(ptr) {}
+        explicit iterator(NodeBase* ptr): _ptr(ptr) {}
 
         iterator& operator++() {
             _ptr = _ptr->getNext();
@@ -60,51 +66,50 @@ public:
         bool operator==(const iterator& rhs) { return _ptr == rhs._ptr; }
         bool operator!=(const iterator& rhs) { return _ptr != rhs._ptr; }
 
-        reference operator*() { return _ptr->getValueRef(); }
-        pointer operator->() { return &_ptr->getValueRef(); }
+        reference operator*() { return static_cast<Node*>(_ptr)->getValueRef(); }
+        pointer operator->() { return &static_cast<Node*>(_ptr)->getValueRef(); }
 
     private:
-        Node* _ptr;
+        friend class list;
+
+        NodeBase* _ptr;
     };
 
 private:
-    class Node {
-    public:
-        Node() : value(), next(nullptr), prev(nullptr) {}
-
-        explicit Node(value_type value, Node* next = nullptr, Node* prev = nullptr) {
-            this->value = value;
-            this->next = next;
-            this->prev = prev;
-        }
+    // Links only; the sentinel is a bare NodeBase and never holds a T.
+    struct NodeBase {
+        NodeBase* prev;
+        NodeBase* next;
 
-        value_type getValue() const { return value; }
-        reference getValueRef() { return value; }
-        const_reference getValueRef() const { return value;}
+        NodeBase* getNext() { return next; }
+        NodeBase* getPrev() { return prev; }
 
-        Node* getNext() { return next; }
-        Node* getPrev() { return prev; }
+        const NodeBase* getNext() const { return next; }
+        const NodeBase* getPrev() const { return prev; }
 
-        const Node* getNext() const { return next; }
-        const Node* getPrev() const { return prev; }
+        void setNext(NodeBase* newNext) { next = newNext; }
+        void setPrev(NodeBase* newPrev) { prev = newPrev; }
+    };
 
-        void setNext(Node* newNext) { next = newNext; }
-        void setPrev(Node* newPrev) { prev = newPrev; }
+    // The value lives in raw storage and is constructed in place through the
+    // allocator, straight from the arguments of the insert. That is also
+    // uses-allocator construction where the allocator does it, as
+    // std::scoped_allocator_adaptor and std::pmr::polymorphic_allocator do:
+    // allocator-aware elements then get the list's allocator.
+    struct Node : NodeBase {
+        alignas(value_type) unsigned char storage[sizeof(value_type)];
 
-        ~Node() {
-            this->next = nullptr;
-            this->prev = nullptr;
-        }
+        value_type* valuePtr() { return std::launder(reinterpret_cast<value_type*>(storage)); }
+        const value_type* valuePtr() const { return std::launder(reinterpret_cast<const value_type*>(storage)); }
 
-    private:
-        value_type value;
-        Node* prev;
-        Node* next;
+        reference getValueRef() { return *valuePtr(); }
+        const_reference getValueRef() const { return *valuePtr(); }
     };
 
 public:
 
     list();
+    explicit list(const Allocator& alloc);
 
     list(const list& other);
     list(const list& other, const Allocator& alloc);
@@ -135,7 +140,7 @@ public:
     bool empty() const noexcept { return _size == 0; }
 
     size_type size() const noexcept { return _size; }
-    size_type maxSize() const noexcept { return _m_alloc.max_size(); }
+    size_type maxSize() const noexcept { return node_alloc_traits::max_size(_m_alloc); }
 
     // Modifiers
     void clear();
@@ -153,12 +158,37 @@ public:
     void emplaceFront(Args&&... args);
     void popFront();
 
+    // Returns the iterator past the erased element.
+    iterator erase(const_iterator pos);
+
     void resize(size_type count);
 
     // Operations
+    //
+    // splice, merge and sort only relink nodes: they never allocate and never
+    // copy or move a T. Nodes can only change hands between lists with equal
+    // allocators, otherwise splice and merge throw std::runtime_error.
+    void splice(const_iterator pos, list& other);
+    void splice(const_iterator pos, list&& other) { splice(pos, other); }
+    void splice(const_iterator pos, list& other, const_iterator it);
+    // O(1) within the list, linear in the length of the range otherwise.
+    void splice(const_iterator pos, list& other, const_iterator first, const_iterator last);
+
+    // Both lists must be sorted; equal elements of this list stay first. If
+    // the comparison throws, the elements already taken over stay here and
+    // the rest stay in `other`.
+    void merge(list& other) { merge(other, std::less<>()); }
+    void merge(list&& other) { merge(other, std::less<>()); }
+    template <typename Compare>
+    void merge(list& other, Compare comp);
+
     void remove(const T& value);
     void unique();
-    void sort();
+
+    // Stable. If the comparison throws, the list is left as it was.
+    void sort() { sort(std::less<>()); }
+    template <typename Compare>
+    void sort(Compare comp);
 
     allocator_type getAllocator() const noexcept { return allocator_type(_m_alloc); }
 
@@ -166,126 +196,119 @@ private:
     using node_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
     using node_alloc_traits = typename std::allocator_traits<node_allocator>;
 
-    void remove(Node* node);
-    static list merge(const list& left, const list& right);
+    template <typename... Args>
+    Node* createNode(Args&&... args);
+    void destroyNode(NodeBase* node) noexcept;
+    template <typename... Args>
+    void emplaceBefore(NodeBase* position, Args&&... args);
+    void remove(NodeBase* node);
+    // Takes over the `size` nodes from `first` to `last`; the list must be empty.
+    void adopt(NodeBase* first, NodeBase* last, size_type size) noexcept;
+    void steal(list& other) noexcept;
+    void checkCompatible(const list& other, const char* what) const;
+    // Moves the `count` nodes from `first` to `last` of `other` before `position`.
+    void transfer(NodeBase* position, list& other, NodeBase* first, NodeBase* last, size_type count) noexcept;
+
+    // sort works on a nullptr-terminated chain through `next` and leaves every
+    // `prev` alone until the end, so the original order can always be rebuilt.
+    template <typename Compare>
+    static NodeBase* sortChain(NodeBase* head, Compare& comp);
+    template <typename Compare>
+    static NodeBase* mergeChains(NodeBase* first, NodeBase* second, Compare& comp);
+
+    static reference valueOf(NodeBase* node) { return static_cast<Node*>(node)->getValueRef(); }
 
     node_allocator _m_alloc;
-    Node* NIL;
-    size_type _size;
+    // The sentinel lives inside the list, so moves and swaps relink the ends
+    // of the chain instead of trading sentinels.
+    NodeBase _sentinel{&_sentinel, &_sentinel};
+    NodeBase* const NIL = &_sentinel;
+    size_type _size = 0;
 };
 
 }  // namespace task
 
 template<typename T, typename Allocator>
-task::list<T, Allocator>::list() : NIL(_m_alloc.allocate(1)) {
-    _size = 0;
-    _m_alloc.construct(NIL);
-    NIL->setNext(NIL);
-    NIL->setPrev(NIL);
-}
+task::list<T, Allocator>::list() {}
+
+template<typename T, typename Allocator>
+task::list<T, Allocator>::list(const Allocator& alloc) : _m_alloc(alloc) {}
 
 template<typename T, typename Allocator>
 task::list<T, Allocator>::list(const task::list<T, Allocator>& other) :
-    _m_alloc(node_alloc_traits::select_on_container_copy_construction(other._m_alloc)),
-    NIL(_m_alloc.allocate(1))
+    _m_alloc(node_alloc_traits::select_on_container_copy_construction(other._m_alloc))
 {
-    _size = 0;
-    _m_alloc.construct(NIL);
-    NIL->setNext(NIL);
-    NIL->setPrev(NIL);
-
     for (auto it = other.begin(); it != other.end(); ++it)
         pushBack(*it);
 }
 
 template<typename T, typename Allocator>
 task::list<T, Allocator>::list(const task::list<T, Allocator>& other, const Allocator& alloc) :
-    _m_alloc(alloc),
-    NIL(_m_alloc.allocate(1))
+    _m_alloc(alloc)
 {
-    _m_alloc.construct(NIL);
-    NIL->setPrev(NIL);
-    NIL->setNext(NIL);
-    _size = 0;
-
     for (auto it = other.begin(); it != other.end(); ++it)
         pushBack(*it);
 }
 
 template<typename T, typename Allocator>
 task::list<T, Allocator>::list(task::list<T, Allocator>&& other, const Allocator& alloc) :
-    _m_alloc(alloc),
-    NIL(std::move(other.NIL)),
-    _size(std::move(other._size))
+    _m_alloc(alloc)
 {
-    other.NIL = nullptr;
+    // Nodes can only change hands between equal allocators, otherwise they
+    // are moved one by one into memory of our own.
+    if (_m_alloc == other._m_alloc) {
+        steal(other);
+    } else {
+        for (iterator it = other.begin(); it != other.end(); ++it)
+            pushBack(std::move(*it));
+    }
 }
 
 template<typename T, typename Allocator>
 task::list<T, Allocator>::list(task::list<T, Allocator>&& other) :
-    _m_alloc(std::move(other._m_alloc)),
-    NIL(std::move(other.NIL)),
-    _size(std::move(other._size))
+    _m_alloc(std::move(other._m_alloc))
 {
-    other.NIL = nullptr;
+    steal(other);
 }
 
 template<typename T, typename Allocator>
 task::list<T, Allocator>::~list() {
-    if (NIL == nullptr)
-        return;
-
-    Node* curr = NIL->getNext();
-    while (curr && curr->getNext() != NIL) {
-        Node* to_free = curr;
+    NodeBase* curr = NIL->getNext();
+    while (curr != NIL) {
+        NodeBase* to_free = curr;
         curr = curr->getNext();
-        _m_alloc.destroy(to_free);
-        _m_alloc.deallocate(to_free, 1);
+        destroyNode(to_free);
     }
-    _m_alloc.destroy(NIL);
-    _m_alloc.deallocate(NIL, 1);
 }
 
 template<typename T, typename Allocator>
 task::list<T, Allocator>& task::list<T, Allocator>::operator=(const task::list<T, Allocator>& other) {
     if (this != &other) {
-        if (node_alloc_traits::propagate_on_container_copy_assignment::value) {
-            if (_m_alloc != other._m_alloc)
-                clear();
-            _m_alloc = other._m_alloc;
-        }
         clear();
-        Node* curr = other.NIL->getNext();
-        for (int i = 0; i < other.size(); ++i) {
-            pushBack(curr->getValue());
-            curr = curr->getNext();
+        if constexpr (node_alloc_traits::propagate_on_container_copy_assignment::value) {
+            _m_alloc = other._m_alloc;
         }
-        _size = other.size();
+        for (auto it = other.begin(); it != other.end(); ++it)
+            pushBack(*it);
     }
     return *this;
 }
 
 template<typename T, typename Allocator>
 task::list<T, Allocator>& task::list<T, Allocator>::operator=(task::list<T, Allocator>&& other) noexcept {
+    if (this == &other)
+        return *this;
     clear();
-    if (node_alloc_traits::propagate_on_container_move_assignment::value) {
-        _m_alloc = std::move(other._m_alloc);
-        _size = std::move(other._size);
-        other._size = std::move(0);
-        NIL = std::move(other.NIL);
-        other.NIL = new Node();
-        other.NIL->setNext(other.NIL);
-        other.NIL->setPrev(other.NIL);
-    } else if (node_alloc_traits::is_always_equal::value || _m_alloc == other._m_alloc) {
-        _size = std::move(other._size);
-        other._size = std::move(0);
-        NIL = std::move(other.NIL);
-        other.NIL = new Node();
-        other.NIL->setNext(other.NIL);
-        other.NIL->setPrev(other.NIL);
-    } else  {
-        for (iterator it = other.begin(); it != other.end(); ++it)
-            pushBack(std::move(*it));
+    if constexpr (node_alloc_traits::propagate_on_container_move_assignment::value) {
+        _m_alloc = other._m_alloc;
+        steal(other);
+    } else {
+        if (node_alloc_traits::is_always_equal::value || _m_alloc == other._m_alloc) {
+            steal(other);
+        } else {
+            for (iterator it = other.begin(); it != other.end(); ++it)
+                pushBack(std::move(*it));
+        }
     }
     return *this;
 }
@@ -298,42 +321,57 @@ void task::list<T, Allocator>::clear() {
 }
 
 template<typename T, typename Allocator>
-void task::list<T, Allocator>::pushBack(const T& value) {
-    Node* last = NIL->getPrev();
-    Node* newNode = static_cast<Node*>(_m_alloc.allocate(1));
-    _m_alloc.construct(newNode, value, NIL, last);
-    NIL->setPrev(newNode);
-    last->setNext(newNode);
+template<typename... Args>
+typename task::list<T, Allocator>::Node* task::list<T, Allocator>::createNode(Args&& ... args) {
+    Node* node = node_alloc_traits::allocate(_m_alloc, 1);
+    ::new(static_cast<void*>(node)) Node;
+    try {
+        node_alloc_traits::construct(_m_alloc, node->valuePtr(), std::forward<Args>(args)...);
+    } catch (...) {
+        node_alloc_traits::deallocate(_m_alloc, node, 1);
+        throw;
+    }
+    return node;
+}
+
+template<typename T, typename Allocator>
+void task::list<T, Allocator>::destroyNode(NodeBase* base) noexcept {
+    Node* node = static_cast<Node*>(base);
+    node_alloc_traits::destroy(_m_alloc, node->valuePtr());
+    node_alloc_traits::deallocate(_m_alloc, node, 1);
+}
+
+template<typename T, typename Allocator>
+template<typename... Args>
+void task::list<T, Allocator>::emplaceBefore(NodeBase* position, Args&& ... args) {
+    NodeBase* newNode = createNode(std::forward<Args>(args)...);
+    NodeBase* prev = position->getPrev();
+    newNode->setPrev(prev);
+    newNode->setNext(position);
+    prev->setNext(newNode);
+    position->setPrev(newNode);
     ++_size;
 }
 
+template<typename T, typename Allocator>
+void task::list<T, Allocator>::pushBack(const T& value) {
+    emplaceBefore(NIL, value);
+}
+
 template<typename T, typename Allocator>
 void task::list<T, Allocator>::pushBack(T&& value) {
-    Node* last = NIL->getPrev();
-    Node* newNode = static_cast<Node*>(_m_alloc.allocate(1));
-    _m_alloc.construct(newNode, std::forward<T>(value),  NIL, last);
-    NIL->setPrev(newNode);
-    last->setNext(newNode);
-    ++_size;
+    emplaceBefore(NIL, std::move(value));
 }
 
 template<typename T, typename Allocator>
 template<typename... Args>
 void task::list<T, Allocator>::emplaceBack(Args&& ... args) {
-    Node* newNode = static_cast<Node*>(_m_alloc.allocate(1));
-    _m_alloc.construct(newNode, std::forward<Args>(args)...);
-
-    Node* last = NIL->getPrev();
-    NIL->setPrev(newNode);
-    newNode->setNext(NIL);
-    newNode->setPrev(last);
-    last->setNext(newNode);
-    ++_size;
+    emplaceBefore(NIL, std::forward<Args>(args)...);
 }
 
 template<typename T, typename Allocator>
 void task::list<T, Allocator>::popBack() {
-    Node* last = NIL->getPrev();
+    NodeBase* last = NIL->getPrev();
     if (last == NIL)
         throw std::logic_error("Cannot pop from empty list");
     remove(last);
@@ -341,136 +379,276 @@ void task::list<T, Allocator>::popBack() {
 
 template<typename T, typename Allocator>
 void task::list<T, Allocator>::pushFront(const T& value) {
-    Node* first = NIL->getNext();
-    Node* newNode = static_cast<Node*>(_m_alloc.allocate(1));
-    _m_alloc.construct(newNode, value, first, NIL);
-    first->setPrev(newNode);
-    NIL->setNext(newNode);
-    ++_size;
+    emplaceBefore(NIL->getNext(), value);
 }
 
 template<typename T, typename Allocator>
 void task::list<T, Allocator>::pushFront(T&& value) {
-    Node* first = NIL->getNext();
-    Node* newNode = static_cast<Node*>(_m_alloc.allocate(1));
-    _m_alloc.construct(newNode, std::forward<T>(value), first, NIL);
-    first->setPrev(newNode);
-    NIL->setNext(newNode);
-    ++_size;
+    emplaceBefore(NIL->getNext(), std::move(value));
 }
 
 template<typename T, typename Allocator>
 template<typename... Args>
 void task::list<T, Allocator>::emplaceFront(Args&& ... args) {
-    Node* newNode = static_cast<Node*>(_m_alloc.allocate(1));
-    _m_alloc.construct(newNode, std::forward<Args>(args)...);
-
-    Node* first = NIL->getNext();
-    NIL->setNext(newNode);
-    newNode->setPrev(NIL);
-    newNode->setNext(first);
-    first->setPrev(newNode);
-    ++_size;
+    emplaceBefore(NIL->getNext(), std::forward<Args>(args)...);
 }
 
 template<typename T, typename Allocator>
 void task::list<T, Allocator>::popFront() {
-    Node* first = NIL->getNext();
+    NodeBase* first = NIL->getNext();
     if (first == NIL)
         throw std::logic_error("Cannot pop from empty list");
     remove(first);
 }
 
+template<typename T, typename Allocator>
+typename task::list<T, Allocator>::iterator task::list<T, Allocator>::erase(const_iterator pos) {
+    if (pos._ptr == NIL)
+        throw std::logic_error("Cannot erase the end of a list");
+    NodeBase* next = pos._ptr->getNext();
+    remove(pos._ptr);
+    return iterator(next);
+}
+
 template<typename T, typename Allocator>
 void task::list<T, Allocator>::resize(size_t count) {
     while (_size > count)
         popBack();
     while (_size < count)
-        pushBack({});
+        emplaceBack();
 }
 
 template<typename T, typename Allocator>
 void task::list<T, Allocator>::remove(const T& value) {
-    Node *tmp = NIL->getNext();
-    while (tmp != NIL) {
-        tmp = tmp->getNext();
-        if (tmp->getPrev()->getValue() == value)
-            remove(tmp->getPrev());
+    // `value` may be an element of this list, so its own node goes last.
+    NodeBase* self = nullptr;
+    NodeBase* curr = NIL->getNext();
+    while (curr != NIL) {
+        NodeBase* next = curr->getNext();
+        if (valueOf(curr) == value) {
+            if (std::addressof(valueOf(curr)) == std::addressof(value))
+                self = curr;
+            else
+                remove(curr);
+        }
+        curr = next;
     }
+    if (self != nullptr)
+        remove(self);
 }
 
 template<typename T, typename Allocator>
-void task::list<T, Allocator>::remove(Node* node) {
-    Node* prev = node->getPrev();
-    Node* next = node->getNext();
+void task::list<T, Allocator>::remove(NodeBase* node) {
+    NodeBase* prev = node->getPrev();
+    NodeBase* next = node->getNext();
     prev->setNext(next);
     next->setPrev(prev);
-    _m_alloc.destroy(node);
-    _m_alloc.deallocate(node, 1);
+    destroyNode(node);
     --_size;
 }
 
+template<typename T, typename Allocator>
+void task::list<T, Allocator>::adopt(NodeBase* first, NodeBase* last, size_type size) noexcept {
+    if (size == 0)
+        return;
+    NIL->setNext(first);
+    NIL->setPrev(last);
+    first->setPrev(NIL);
+    last->setNext(NIL);
+    _size = size;
+}
+
+template<typename T, typename Allocator>
+void task::list<T, Allocator>::steal(task::list<T, Allocator>& other) noexcept {
+    adopt(other.NIL->getNext(), other.NIL->getPrev(), other._size);
+    other.NIL->setNext(other.NIL);
+    other.NIL->setPrev(other.NIL);
+    other._size = 0;
+}
+
 template<typename T, typename Allocator>
 void task::list<T, Allocator>::unique() {
-    Node *tmp = NIL->getNext()->getNext();
+    NodeBase* curr = NIL->getNext();
+    while (curr != NIL && curr->getNext() != NIL) {
+        NodeBase* next = curr->getNext();
+        if (valueOf(curr) == valueOf(next))
+            remove(next);
+        else
+            curr = next;
+    }
+}
+
+template<typename T, typename Allocator>
+void task::list<T, Allocator>::checkCompatible(const task::list<T, Allocator>& other, const char* what) const {
+    if (!node_alloc_traits::is_always_equal::value && _m_alloc != other._m_alloc)
+        throw std::runtime_error(std::string(what) + " with different allocators");
+}
+
+template<typename T, typename Allocator>
+void task::list<T, Allocator>::transfer(NodeBase* position, task::list<T, Allocator>& other,
+                                        NodeBase* first, NodeBase* last, size_type count) noexcept {
+    NodeBase* before = first->getPrev();
+    NodeBase* after = last->getNext();
+    before->setNext(after);
+    after->setPrev(before);
+    other._size -= count;
+
+    NodeBase* prev = position->getPrev();
+    prev->setNext(first);
+    first->setPrev(prev);
+    last->setNext(position);
+    position->setPrev(last);
+    _size += count;
+}
+
+template<typename T, typename Allocator>
+void task::list<T, Allocator>::splice(const_iterator pos, task::list<T, Allocator>& other) {
+    if (this == &other || other.empty())
+        return;
+    checkCompatible(other, "Splice");
+    transfer(pos._ptr, other, other.NIL->getNext(), other.NIL->getPrev(), other._size);
+}
 
-    while (tmp->getPrev() != NIL) {
-        Node *prev = tmp->getPrev();
-        if (prev->getValue() == tmp->getValue())
-            remove(prev);
-        tmp = tmp->getNext();
+template<typename T, typename Allocator>
+void task::list<T, Allocator>::splice(const_iterator pos, task::list<T, Allocator>& other, const_iterator it) {
+    if (pos._ptr == it._ptr || pos._ptr == it._ptr->getNext())
+        return;
+    if (this != &other)
+        checkCompatible(other, "Splice");
+    transfer(pos._ptr, other, it._ptr, it._ptr, 1);
+}
+
+template<typename T, typename Allocator>
+void task::list<T, Allocator>::splice(const_iterator pos, task::list<T, Allocator>& other,
+                                      const_iterator first, const_iterator last) {
+    if (first._ptr == last._ptr)
+        return;
+    size_type count = 0;
+    if (this != &other) {
+        checkCompatible(other, "Splice");
+        for (NodeBase* node = first._ptr; node != last._ptr; node = node->getNext())
+            ++count;
+    }
+    // Within one list the size does not change, so the count does not matter.
+    transfer(pos._ptr, other, first._ptr, last._ptr->getPrev(), count);
+}
+
+template<typename T, typename Allocator>
+template<typename Compare>
+void task::list<T, Allocator>::merge(task::list<T, Allocator>& other, Compare comp) {
+    if (this == &other || other.empty())
+        return;
+    checkCompatible(other, "Merge");
+    NodeBase* curr = NIL->getNext();
+    while (!other.empty()) {
+        if (curr == NIL) {
+            transfer(NIL, other, other.NIL->getNext(), other.NIL->getPrev(), other._size);
+            return;
+        }
+        NodeBase* take = other.NIL->getNext();
+        if (comp(valueOf(take), valueOf(curr)))
+            transfer(curr, other, take, take, 1);
+        else
+            curr = curr->getNext();
     }
 }
 
 template<typename T, typename Allocator>
-task::list<T, Allocator> task::list<T, Allocator>::merge(const task::list<T, Allocator>& first, const task::list<T, Allocator>& second) {
-    task::list<T, Allocator> result;
-    Node* fHead = first.NIL->getNext();
-    Node* sHead = second.NIL->getNext();
-    while (fHead != first.NIL || sHead != second.NIL) {
-        if (sHead == second.NIL) {
-            result.pushBack(std::move(fHead->getValue()));
-            fHead = fHead->getNext();
-        } else if (fHead == first.NIL) {
-            result.pushBack(std::move(sHead->getValue()));
-            sHead = sHead->getNext();
-        } else if (sHead->getValue() > fHead->getValue()) {
-            result.pushBack(std::move(fHead->getValue()));
-            fHead = fHead->getNext();
+template<typename Compare>
+typename task::list<T, Allocator>::NodeBase*
+task::list<T, Allocator>::mergeChains(NodeBase* first, NodeBase* second, Compare& comp) {
+    NodeBase head{nullptr, nullptr};
+    NodeBase* tail = &head;
+    while (first != nullptr && second != nullptr) {
+        // Ties go to `first`, which holds the earlier elements.
+        if (comp(valueOf(second), valueOf(first))) {
+            tail->setNext(second);
+            second = second->getNext();
         } else {
-            result.pushBack(std::move(sHead->getValue()));
-            sHead = sHead->getNext();
+            tail->setNext(first);
+            first = first->getNext();
         }
+        tail = tail->getNext();
+    }
+    tail->setNext(first != nullptr ? first : second);
+    return head.getNext();
+}
+
+template<typename T, typename Allocator>
+template<typename Compare>
+typename task::list<T, Allocator>::NodeBase*
+task::list<T, Allocator>::sortChain(NodeBase* head, Compare& comp) {
+    // Bottom-up merge sort: bins[i] holds a sorted run of 2^i nodes, or is
+    // empty, and every new node is carried through them like a binary counter.
+    // 64 bins are enough for any list that fits in memory.
+    NodeBase* bins[64] = {};
+    int used = 0;
+    while (head != nullptr) {
+        NodeBase* carry = head;
+        head = head->getNext();
+        carry->setNext(nullptr);
+        int i = 0;
+        for (; i < used && bins[i] != nullptr; i++) {
+            // bins[i] holds earlier elements than carry.
+            carry = mergeChains(bins[i], carry, comp);
+            bins[i] = nullptr;
+        }
+        bins[i] = carry;
+        if (i == used)
+            used++;
+    }
+    NodeBase* result = nullptr;
+    for (int i = 0; i < used; i++) {
+        if (bins[i] != nullptr)
+            result = result == nullptr ? bins[i] : mergeChains(bins[i], result, comp);
     }
     return result;
 }
 
 template<typename T, typename Allocator>
-void task::list<T, Allocator>::sort() {
+template<typename Compare>
+void task::list<T, Allocator>::sort(Compare comp) {
     if (_size < 2)
         return;
-    task::list<T, Allocator> left;
-    task::list<T, Allocator> right(*this);
-    Node* tmp = NIL->getNext();
-    for (size_t i = 0; i < _size / 2; i++) {
-        left.pushBack(std::move(tmp->getValue()));
-        tmp = tmp->getNext();
-        right.popFront();
+    NIL->getPrev()->setNext(nullptr);
+    NodeBase* head;
+    try {
+        head = sortChain(NIL->getNext(), comp);
+    } catch (...) {
+        // The prev links still describe the original order.
+        for (NodeBase* node = NIL; ; node = node->getPrev()) {
+            node->getPrev()->setNext(node);
+            if (node->getPrev() == NIL)
+                break;
+        }
+        throw;
+    }
+    NodeBase* prev = NIL;
+    for (NodeBase* node = head; node != nullptr; node = node->getNext()) {
+        node->setPrev(prev);
+        prev->setNext(node);
+        prev = node;
     }
-    left.sort();
-    right.sort();
-    auto res = merge(left, right);
-    *this = std::move(res);
+    prev->setNext(NIL);
+    NIL->setPrev(prev);
 }
 
 template<typename T, typename Allocator>
 void task::list<T, Allocator>::swap(task::list<T, Allocator>& other) {
-    if (node_alloc_traits::propagate_on_container_swap::value)
+    if constexpr (node_alloc_traits::propagate_on_container_swap::value) {
         std::swap(_m_alloc, other._m_alloc);
-    else if (_m_alloc == other._m_alloc)
-        throw std::runtime_error("Swap with different allocators");
-    std::swap(NIL, other.NIL);
-    std::swap(_size, other._size);
+    } else {
+        if (_m_alloc != other._m_alloc)
+            throw std::runtime_error("Swap with different allocators");
+    }
+    NodeBase* first = NIL->getNext();
+    NodeBase* last = NIL->getPrev();
+    size_type size = _size;
+    NIL->setNext(NIL);
+    NIL->setPrev(NIL);
+    _size = 0;
+    steal(other);
+    other.adopt(first, last, size);
 }
 
 template<typename T, typename Allocator>
@@ -478,7 +656,7 @@ typename task::list<T, Allocator>::reference task::list<T, Allocator>::front() {
     if (!size())
         throw std::runtime_error("Cannot return front of empty list");
 
-    return NIL->getNext()->getValueRef();
+    return valueOf(NIL->getNext());
 }
 
 template<typename T, typename Allocator>
@@ -486,7 +664,7 @@ typename task::list<T, Allocator>::const_reference task::list<T, Allocator>::fro
     if (!size())
         throw std::runtime_error("Cannot return front of empty list");
 
-    return NIL->getNext()->getValueRef();
+    return static_cast<const Node*>(NIL->getNext())->getValueRef();
 }
 
 template<typename T, typename Allocator>
@@ -494,7 +672,7 @@ typename task::list<T, Allocator>::reference task::list<T, Allocator>::back() {
     if (!size())
         throw std::runtime_error("Cannot return back of empty list");
 
-    return NIL->getPrev()->getValueRef();
+    return valueOf(NIL->getPrev());
 }
 
 template<typename T, typename Allocator>
@@ -502,5 +680,5 @@ typename task::list<T, Allocator>::const_reference task::list<T, Allocator>::bac
     if (!size())
         throw std::runtime_error("Cannot return back of empty list");
 
-    return NIL->getPrev()->getValueRef();
+    return static_cast<const Node*>(NIL->getPrev())->getValueRef();
 }
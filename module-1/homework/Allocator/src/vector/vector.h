@@ -0,0 +1,457 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <ratio>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "type_traits/move_if_noexcept.h"
+
+namespace task {
+
+// Whether objects of T can change address by copying their bytes and simply
+// forgetting the originals, without running a move constructor and a
+// destructor. True for trivially copyable types; specialize it for others
+// that qualify, such as types that only hold owning pointers.
+template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+// Contiguous container over the same allocators as task::list. Capacity grows
+// by GrowthFactor, a std::ratio above 1, whenever it runs out.
+//
+// Reallocation relocates the elements: trivially relocatable types are copied
+// with one memcpy, anything else is moved with MoveIfNoExcept and destroyed,
+// so growth keeps the strong guarantee unless T has a throwing move and no copy.
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthFactor = std::ratio<2>>
+class vector {
+    static_assert(GrowthFactor::num > GrowthFactor::den, "vector must grow by a factor above 1");
+
+    using alloc_traits = std::allocator_traits<Allocator>;
+
+public:
+    using value_type = T;
+    using reference = T&;
+    using const_reference = const T&;
+    using allocator_type = Allocator;
+    using pointer = typename std::allocator_traits<Allocator>::pointer;
+    using const_pointer = typename std::allocator_traits<Allocator>::const_pointer;
+    using iterator = T*;
+    using const_iterator = const T*;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    vector() = default;
+    explicit vector(const Allocator& alloc);
+    explicit vector(size_type count, const Allocator& alloc = Allocator());
+
+    vector(const vector& other);
+    vector(const vector& other, const Allocator& alloc);
+
+    vector(vector&& other) noexcept;
+    vector(vector&& other, const Allocator& alloc);
+
+    ~vector();
+
+    vector& operator=(const vector& other);
+    // Only moves elements one by one, and so may throw, when the allocators
+    // neither propagate nor are always equal.
+    vector& operator=(vector&& other) noexcept(alloc_traits::propagate_on_container_move_assignment::value ||
+                                               alloc_traits::is_always_equal::value);
+
+    // Element access
+    reference operator[](size_type pos) { return _begin[pos]; }
+    const_reference operator[](size_type pos) const { return _begin[pos]; }
+    reference at(size_type pos);
+    const_reference at(size_type pos) const;
+    reference front();
+    const_reference front() const;
+    reference back();
+    const_reference back() const;
+    T* data() noexcept { return _begin; }
+    const T* data() const noexcept { return _begin; }
+
+    // Iterators
+    iterator begin() noexcept { return _begin; }
+    const_iterator begin() const noexcept { return _begin; }
+
+    iterator end() noexcept { return _end; }
+    const_iterator end() const noexcept { return _end; }
+
+    // Capacity
+    bool empty() const noexcept { return _begin == _end; }
+
+    size_type size() const noexcept { return static_cast<size_type>(_end - _begin); }
+    size_type maxSize() const noexcept { return alloc_traits::max_size(_m_alloc); }
+    size_type capacity() const noexcept { return static_cast<size_type>(_capacity_end - _begin); }
+
+    // Reallocates to exactly `new_capacity` if that is more than there is.
+    void reserve(size_type new_capacity);
+    // Reallocates to exactly size(), or frees the storage of an empty vector.
+    void shrinkToFit();
+
+    // Modifiers
+    void clear() noexcept;
+    void swap(vector& other);
+
+    void pushBack(const T& value);
+    void pushBack(T&& value);
+
+    template <typename... Args>
+    reference emplaceBack(Args&&... args);
+    void popBack();
+
+    void resize(size_type count);
+
+    allocator_type getAllocator() const noexcept { return _m_alloc; }
+
+private:
+    // Capacity after growing to hold at least `min_capacity` elements.
+    size_type grownCapacity(size_type min_capacity) const;
+    // Moves [first, last) into raw `destination` and ends the lifetime of the
+    // originals. On exception nothing is left in `destination` and the
+    // originals are untouched.
+    void relocate(T* first, T* last, T* destination);
+    void reallocate(size_type new_capacity);
+    void destroy(T* first, T* last) noexcept;
+    // Destroys everything and frees the storage.
+    void release() noexcept;
+    void steal(vector& other) noexcept;
+
+    Allocator _m_alloc;
+    T* _begin = nullptr;
+    T* _end = nullptr;
+    T* _capacity_end = nullptr;
+};
+
+}  // namespace task
+
+template<typename T, typename Allocator, typename GrowthFactor>
+task::vector<T, Allocator, GrowthFactor>::vector(const Allocator& alloc) : _m_alloc(alloc) {}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+task::vector<T, Allocator, GrowthFactor>::vector(size_type count, const Allocator& alloc) : _m_alloc(alloc) {
+    try {
+        resize(count);
+    } catch (...) {
+        release();
+        throw;
+    }
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+task::vector<T, Allocator, GrowthFactor>::vector(const task::vector<T, Allocator, GrowthFactor>& other) :
+    vector(other, alloc_traits::select_on_container_copy_construction(other._m_alloc)) {}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+task::vector<T, Allocator, GrowthFactor>::vector(const task::vector<T, Allocator, GrowthFactor>& other,
+                                                 const Allocator& alloc) :
+    _m_alloc(alloc)
+{
+    reserve(other.size());
+    try {
+        for (const T& value : other)
+            emplaceBack(value);
+    } catch (...) {
+        release();
+        throw;
+    }
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+task::vector<T, Allocator, GrowthFactor>::vector(task::vector<T, Allocator, GrowthFactor>&& other) noexcept :
+    _m_alloc(std::move(other._m_alloc))
+{
+    steal(other);
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+task::vector<T, Allocator, GrowthFactor>::vector(task::vector<T, Allocator, GrowthFactor>&& other,
+                                                 const Allocator& alloc) :
+    _m_alloc(alloc)
+{
+    // Storage can only change hands between equal allocators, otherwise the
+    // elements are moved one by one into storage of our own.
+    if (_m_alloc == other._m_alloc) {
+        steal(other);
+        return;
+    }
+    reserve(other.size());
+    try {
+        for (T& value : other)
+            emplaceBack(std::move(value));
+    } catch (...) {
+        release();
+        throw;
+    }
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+task::vector<T, Allocator, GrowthFactor>::~vector() {
+    release();
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+task::vector<T, Allocator, GrowthFactor>&
+task::vector<T, Allocator, GrowthFactor>::operator=(const task::vector<T, Allocator, GrowthFactor>& other) {
+    if (this == &other)
+        return *this;
+    if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+        // Our storage has to go back to the allocator it came from.
+        if (_m_alloc != other._m_alloc)
+            release();
+        _m_alloc = other._m_alloc;
+    }
+    clear();
+    reserve(other.size());
+    for (const T& value : other)
+        emplaceBack(value);
+    return *this;
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+task::vector<T, Allocator, GrowthFactor>&
+task::vector<T, Allocator, GrowthFactor>::operator=(task::vector<T, Allocator, GrowthFactor>&& other)
+    noexcept(alloc_traits::propagate_on_container_move_assignment::value || alloc_traits::is_always_equal::value) {
+    if (this == &other)
+        return *this;
+    if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+        release();
+        _m_alloc = other._m_alloc;
+        steal(other);
+    } else {
+        if (alloc_traits::is_always_equal::value || _m_alloc == other._m_alloc) {
+            release();
+            steal(other);
+        } else {
+            clear();
+            reserve(other.size());
+            for (T& value : other)
+                emplaceBack(std::move(value));
+        }
+    }
+    return *this;
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+typename task::vector<T, Allocator, GrowthFactor>::reference task::vector<T, Allocator, GrowthFactor>::at(size_type pos) {
+    if (pos >= size())
+        throw std::out_of_range("Index is out of range");
+    return _begin[pos];
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+typename task::vector<T, Allocator, GrowthFactor>::const_reference
+task::vector<T, Allocator, GrowthFactor>::at(size_type pos) const {
+    if (pos >= size())
+        throw std::out_of_range("Index is out of range");
+    return _begin[pos];
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+typename task::vector<T, Allocator, GrowthFactor>::reference task::vector<T, Allocator, GrowthFactor>::front() {
+    if (empty())
+        throw std::runtime_error("Cannot return front of empty vector");
+    return *_begin;
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+typename task::vector<T, Allocator, GrowthFactor>::const_reference task::vector<T, Allocator, GrowthFactor>::front() const {
+    if (empty())
+        throw std::runtime_error("Cannot return front of empty vector");
+    return *_begin;
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+typename task::vector<T, Allocator, GrowthFactor>::reference task::vector<T, Allocator, GrowthFactor>::back() {
+    if (empty())
+        throw std::runtime_error("Cannot return back of empty vector");
+    return *(_end - 1);
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+typename task::vector<T, Allocator, GrowthFactor>::const_reference task::vector<T, Allocator, GrowthFactor>::back() const {
+    if (empty())
+        throw std::runtime_error("Cannot return back of empty vector");
+    return *(_end - 1);
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+void task::vector<T, Allocator, GrowthFactor>::reserve(size_type new_capacity) {
+    if (new_capacity > maxSize())
+        throw std::length_error("Cannot reserve more than maxSize() elements");
+    if (new_capacity > capacity())
+        reallocate(new_capacity);
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+void task::vector<T, Allocator, GrowthFactor>::shrinkToFit() {
+    if (empty())
+        release();
+    else if (capacity() > size())
+        reallocate(size());
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+void task::vector<T, Allocator, GrowthFactor>::clear() noexcept {
+    destroy(_begin, _end);
+    _end = _begin;
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+void task::vector<T, Allocator, GrowthFactor>::swap(task::vector<T, Allocator, GrowthFactor>& other) {
+    if constexpr (alloc_traits::propagate_on_container_swap::value) {
+        std::swap(_m_alloc, other._m_alloc);
+    } else {
+        if (_m_alloc != other._m_alloc)
+            throw std::runtime_error("Swap with different allocators");
+    }
+    std::swap(_begin, other._begin);
+    std::swap(_end, other._end);
+    std::swap(_capacity_end, other._capacity_end);
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+void task::vector<T, Allocator, GrowthFactor>::pushBack(const T& value) {
+    emplaceBack(value);
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+void task::vector<T, Allocator, GrowthFactor>::pushBack(T&& value) {
+    emplaceBack(std::move(value));
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+template<typename... Args>
+typename task::vector<T, Allocator, GrowthFactor>::reference
+task::vector<T, Allocator, GrowthFactor>::emplaceBack(Args&& ... args) {
+    if (_end != _capacity_end) {
+        alloc_traits::construct(_m_alloc, _end, std::forward<Args>(args)...);
+        return *_end++;
+    }
+    // The arguments may refer to an element, so the new one is built before
+    // the old ones leave.
+    size_type count = size();
+    size_type new_capacity = grownCapacity(count + 1);
+    T* storage = alloc_traits::allocate(_m_alloc, new_capacity);
+    try {
+        alloc_traits::construct(_m_alloc, storage + count, std::forward<Args>(args)...);
+    } catch (...) {
+        alloc_traits::deallocate(_m_alloc, storage, new_capacity);
+        throw;
+    }
+    try {
+        relocate(_begin, _end, storage);
+    } catch (...) {
+        alloc_traits::destroy(_m_alloc, storage + count);
+        alloc_traits::deallocate(_m_alloc, storage, new_capacity);
+        throw;
+    }
+    if (_begin != nullptr)
+        alloc_traits::deallocate(_m_alloc, _begin, capacity());
+    _begin = storage;
+    _end = storage + count + 1;
+    _capacity_end = storage + new_capacity;
+    return storage[count];
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+void task::vector<T, Allocator, GrowthFactor>::popBack() {
+    if (empty())
+        throw std::logic_error("Cannot pop from empty vector");
+    --_end;
+    alloc_traits::destroy(_m_alloc, _end);
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+void task::vector<T, Allocator, GrowthFactor>::resize(size_type count) {
+    if (count <= size()) {
+        destroy(_begin + count, _end);
+        _end = _begin + count;
+        return;
+    }
+    if (count > capacity())
+        reallocate(grownCapacity(count));
+    T* old_end = _end;
+    try {
+        for (; _end != _begin + count; ++_end)
+            alloc_traits::construct(_m_alloc, _end);
+    } catch (...) {
+        destroy(old_end, _end);
+        _end = old_end;
+        throw;
+    }
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+typename task::vector<T, Allocator, GrowthFactor>::size_type
+task::vector<T, Allocator, GrowthFactor>::grownCapacity(size_type min_capacity) const {
+    if (min_capacity > maxSize())
+        throw std::length_error("Cannot grow past maxSize() elements");
+    size_type current = capacity();
+    if (current > maxSize() / GrowthFactor::num)
+        return maxSize();
+    return std::max(current * GrowthFactor::num / GrowthFactor::den, min_capacity);
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+void task::vector<T, Allocator, GrowthFactor>::relocate(T* first, T* last, T* destination) {
+    if constexpr (IsTriviallyRelocatable<T>::value) {
+        if (first != last)
+            std::memcpy(static_cast<void*>(destination), static_cast<const void*>(first), (last - first) * sizeof(T));
+    } else {
+        T* built = destination;
+        try {
+            for (T* source = first; source != last; ++source, ++built)
+                alloc_traits::construct(_m_alloc, built, MoveIfNoExcept(*source));
+        } catch (...) {
+            destroy(destination, built);
+            throw;
+        }
+        destroy(first, last);
+    }
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+void task::vector<T, Allocator, GrowthFactor>::reallocate(size_type new_capacity) {
+    size_type count = size();
+    T* storage = alloc_traits::allocate(_m_alloc, new_capacity);
+    try {
+        relocate(_begin, _end, storage);
+    } catch (...) {
+        alloc_traits::deallocate(_m_alloc, storage, new_capacity);
+        throw;
+    }
+    if (_begin != nullptr)
+        alloc_traits::deallocate(_m_alloc, _begin, capacity());
+    _begin = storage;
+    _end = storage + count;
+    _capacity_end = storage + new_capacity;
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+void task::vector<T, Allocator, GrowthFactor>::destroy(T* first, T* last) noexcept {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        for (; first != last; ++first)
+            alloc_traits::destroy(_m_alloc, first);
+    }
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+void task::vector<T, Allocator, GrowthFactor>::release() noexcept {
+    if (_begin == nullptr)
+        return;
+    destroy(_begin, _end);
+    alloc_traits::deallocate(_m_alloc, _begin, capacity());
+    _begin = _end = _capacity_end = nullptr;
+}
+
+template<typename T, typename Allocator, typename GrowthFactor>
+void task::vector<T, Allocator, GrowthFactor>::steal(task::vector<T, Allocator, GrowthFactor>& other) noexcept {
+    _begin = std::exchange(other._begin, nullptr);
+    _end = std::exchange(other._end, nullptr);
+    _capacity_end = std::exchange(other._capacity_end, nullptr);
+}
@@ -1,11 +1,26 @@
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <list>
+#include <memory_resource>
+#include <mutex>
+#include <numeric>
 #include <random>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "src/allocator/allocator.h"
+#include "src/allocator/arena_resource.h"
+#include "src/allocator/concurrent_allocator.h"
+#include "src/allocator/mapped_arena.h"
+#include "src/allocator/short_alloc.h"
+#include "src/allocator/slab_allocator.h"
+#include "src/allocator/stats_allocator.h"
 #include "src/list/list.h"
+#include "src/vector/vector.h"
 
 TEST(CopyAssignment, Test) {
     task::list<std::string, CustomAllocator<std::string>> actual;
@@ -258,6 +273,1094 @@ TEST(Mixed, Test1) {
     ASSERT_TRUE(std::equal(actual.begin(), actual.end(), expected.begin(), expected.end()));
 }
 
+namespace {
+
+// Counts how it gets built; has no default constructor.
+struct Heavy {
+    static int constructions;
+    static int copies;
+    static int moves;
+
+    Heavy(int first, std::string second) : number(first), text(std::move(second)) { constructions++; }
+    Heavy(const Heavy& other) : number(other.number), text(other.text) { copies++; }
+    Heavy(Heavy&& other) noexcept : number(other.number), text(std::move(other.text)) { moves++; }
+    Heavy& operator=(const Heavy&) = delete;
+    Heavy& operator=(Heavy&&) = delete;
+
+    static void resetCounters() { constructions = copies = moves = 0; }
+
+    int number;
+    std::string text;
+};
+
+int Heavy::constructions = 0;
+int Heavy::copies = 0;
+int Heavy::moves = 0;
+
+}  // namespace
+
+TEST(EmplaceBack, ConstructsInPlace) {
+    task::list<Heavy, CustomAllocator<Heavy>> actual;
+    Heavy::resetCounters();
+    actual.emplaceBack(1, "one");
+    actual.emplaceFront(0, "zero");
+    ASSERT_EQ(Heavy::constructions, 2);
+    ASSERT_EQ(Heavy::copies + Heavy::moves, 0);
+
+    Heavy heavy(2, "two");
+    Heavy::resetCounters();
+    actual.pushBack(std::move(heavy));
+    ASSERT_EQ(Heavy::moves, 1);
+    ASSERT_EQ(Heavy::copies, 0);
+    actual.pushFront(actual.back());
+    ASSERT_EQ(Heavy::copies, 1);
+
+    ASSERT_EQ(actual.size(), 4);
+    ASSERT_EQ(actual.front().text, "two");
+    ASSERT_EQ((++actual.begin())->text, "zero");
+    ASSERT_EQ(actual.back().number, 2);
+}
+
+TEST(Remove, ValueFromTheListItself) {
+    task::list<std::string, CustomAllocator<std::string>> actual;
+    for (const char* word : {"a", "b", "a", "c", "a"})
+        actual.pushBack(word);
+    actual.remove(actual.front());
+    std::list<std::string> expected = {"b", "c"};
+    ASSERT_TRUE(std::equal(actual.begin(), actual.end(), expected.begin(), expected.end()));
+}
+
+TEST(Erase, ReturnsTheNextElement) {
+    task::list<int> actual;
+    for (int i = 0; i < 10; i++)
+        actual.pushBack(i);
+    for (auto it = actual.begin(); it != actual.end();)
+        it = *it % 3 == 0 ? actual.erase(it) : ++it;
+    std::list<int> expected = {1, 2, 4, 5, 7, 8};
+    ASSERT_EQ(actual.size(), expected.size());
+    ASSERT_TRUE(std::equal(actual.begin(), actual.end(), expected.begin(), expected.end()));
+    ASSERT_THROW(actual.erase(actual.end()), std::logic_error);
+}
+
+TEST(Sort, RelinksWithoutCopyingOrAllocating) {
+    detail::Arena arena;
+    task::list<Heavy, CustomAllocator<Heavy>> actual{CustomAllocator<Heavy>(arena)};
+    for (int i = 0; i < 1000; i++)
+        actual.emplaceBack((i * 7919) % 100, std::to_string(i));
+    std::size_t capacity = arena.capacity();
+    Heavy::resetCounters();
+
+    actual.sort([](const Heavy& left, const Heavy& right) { return left.number < right.number; });
+
+    ASSERT_EQ(Heavy::constructions + Heavy::copies + Heavy::moves, 0);
+    ASSERT_EQ(arena.capacity(), capacity);
+    ASSERT_EQ(actual.size(), 1000);
+    // Stable: equal numbers keep the order they were inserted in.
+    int previous = -1;
+    int previous_index = -1;
+    for (const Heavy& heavy : actual) {
+        int index = std::stoi(heavy.text);
+        ASSERT_LE(previous, heavy.number);
+        if (previous == heavy.number) {
+            ASSERT_LT(previous_index, index);
+        }
+        previous = heavy.number;
+        previous_index = index;
+    }
+}
+
+TEST(Sort, ThrowingComparisonLeavesTheListAsItWas) {
+    task::list<int> actual;
+    std::list<int> expected;
+    for (int i = 0; i < 100; i++) {
+        actual.pushBack((i * 37) % 101);
+        expected.push_back((i * 37) % 101);
+    }
+    int calls = 0;
+    ASSERT_THROW(actual.sort([&calls](int left, int right) {
+        if (++calls == 300)
+            throw std::runtime_error("comparison failed");
+        return left < right;
+    }), std::runtime_error);
+    ASSERT_EQ(actual.size(), 100);
+    ASSERT_TRUE(std::equal(actual.begin(), actual.end(), expected.begin(), expected.end()));
+    ASSERT_TRUE(std::equal(std::make_reverse_iterator(actual.end()), std::make_reverse_iterator(actual.begin()),
+                           expected.rbegin(), expected.rend()));
+}
+
+TEST(Merge, TakesOverTheNodes) {
+    detail::Arena arena;
+    CustomAllocator<std::string> allocator(arena);
+    task::list<std::string, CustomAllocator<std::string>> actual(allocator);
+    task::list<std::string, CustomAllocator<std::string>> other(allocator);
+    for (const char* word : {"a", "c", "e", "e"})
+        actual.pushBack(word);
+    for (const char* word : {"b", "e", "f"})
+        other.pushBack(word);
+    const std::string* moved = &other.back();
+    std::size_t capacity = arena.capacity();
+
+    actual.merge(other);
+
+    ASSERT_TRUE(other.empty());
+    ASSERT_TRUE(other.begin() == other.end());
+    ASSERT_EQ(arena.capacity(), capacity);
+    ASSERT_EQ(&actual.back(), moved);
+    std::list<std::string> expected = {"a", "b", "c", "e", "e", "e", "f"};
+    ASSERT_EQ(actual.size(), expected.size());
+    ASSERT_TRUE(std::equal(actual.begin(), actual.end(), expected.begin(), expected.end()));
+
+    task::list<std::string, CustomAllocator<std::string>> foreign;
+    foreign.pushBack("z");
+    ASSERT_THROW(actual.merge(foreign), std::runtime_error);
+    ASSERT_EQ(foreign.size(), 1);
+}
+
+TEST(Splice, MovesNodesBetweenLists) {
+    task::list<int> actual;
+    task::list<int> other;
+    for (int i = 0; i < 5; i++) {
+        actual.pushBack(i);
+        other.pushBack(10 + i);
+    }
+    auto third = ++ ++other.begin();
+    const int* kept = &*third;
+
+    actual.splice(++actual.begin(), other, third);
+    ASSERT_EQ(&*++actual.begin(), kept);
+    ASSERT_EQ(actual.size(), 6);
+    ASSERT_EQ(other.size(), 4);
+
+    actual.splice(actual.end(), other, ++other.begin(), other.end());
+    ASSERT_EQ(other.size(), 1);
+    actual.splice(actual.begin(), other);
+    ASSERT_TRUE(other.empty());
+    // Within the list: the last element to the front.
+    actual.splice(actual.begin(), actual, --actual.end());
+
+    std::list<int> expected = {14, 10, 0, 12, 1, 2, 3, 4, 11, 13};
+    ASSERT_EQ(actual.size(), expected.size());
+    ASSERT_TRUE(std::equal(actual.begin(), actual.end(), expected.begin(), expected.end()));
+    ASSERT_TRUE(std::equal(std::make_reverse_iterator(actual.end()), std::make_reverse_iterator(actual.begin()),
+                           expected.rbegin(), expected.rend()));
+}
+
+namespace {
+
+// Counts the moves and copies a vector makes while it grows.
+template <bool NothrowMove>
+struct Tracked {
+    static int copies;
+    static int moves;
+    // The copy that throws, counting from 1; 0 for never.
+    static int throw_on_copy;
+
+    explicit Tracked(int v) : value(v) {}
+    Tracked(const Tracked& other) : value(other.value) {
+        if (++copies == throw_on_copy)
+            throw std::runtime_error("copy failed");
+    }
+    Tracked(Tracked&& other) noexcept(NothrowMove) : value(other.value) { moves++; }
+
+    static void resetCounters() { copies = moves = throw_on_copy = 0; }
+
+    int value;
+};
+
+template <bool NothrowMove>
+int Tracked<NothrowMove>::copies = 0;
+template <bool NothrowMove>
+int Tracked<NothrowMove>::moves = 0;
+template <bool NothrowMove>
+int Tracked<NothrowMove>::throw_on_copy = 0;
+
+// Owns its buffer, so it is not trivially copyable, but moving its bytes is fine.
+struct Relocatable {
+    static int moves;
+    static int destructions;
+
+    explicit Relocatable(int v) : value(std::make_unique<int>(v)) {}
+    Relocatable(Relocatable&& other) noexcept : value(std::move(other.value)) { moves++; }
+    ~Relocatable() { destructions++; }
+
+    std::unique_ptr<int> value;
+};
+
+int Relocatable::moves = 0;
+int Relocatable::destructions = 0;
+
+}  // namespace
+
+template <>
+struct task::IsTriviallyRelocatable<Relocatable> : std::true_type {};
+
+TEST(Vector, MatchesStdVector) {
+    std::mt19937 random_engine(7);
+    std::uniform_int_distribution<int> operation(0, 9);
+    task::vector<std::string, CustomAllocator<std::string>> actual;
+    std::vector<std::string> expected;
+    for (int i = 0; i < 5000; i++) {
+        int op = operation(random_engine);
+        if (op < 6) {
+            actual.pushBack(std::to_string(i));
+            expected.push_back(std::to_string(i));
+        } else if (op < 8 && !expected.empty()) {
+            actual.popBack();
+            expected.pop_back();
+        } else if (op == 8) {
+            actual.resize(expected.size() / 2 + 3);
+            expected.resize(expected.size() / 2 + 3);
+        } else {
+            actual.emplaceBack(actual.empty() ? "x" : actual.front());
+            expected.push_back(expected.empty() ? "x" : expected.front());
+        }
+    }
+    ASSERT_TRUE(std::equal(actual.begin(), actual.end(), expected.begin(), expected.end()));
+
+    auto copy = actual;
+    auto moved = std::move(actual);
+    ASSERT_TRUE(actual.empty());
+    ASSERT_TRUE(std::equal(copy.begin(), copy.end(), moved.begin(), moved.end()));
+    ASSERT_EQ(copy.at(3), expected.at(3));
+    ASSERT_THROW(copy.at(copy.size()), std::out_of_range);
+}
+
+TEST(Vector, GrowthMovesOnlyWhenMovesCannotThrow) {
+    task::vector<Tracked<true>> safe;
+    task::vector<Tracked<false>> unsafe;
+    Tracked<true>::resetCounters();
+    Tracked<false>::resetCounters();
+    for (int i = 0; i < 100; i++) {
+        safe.emplaceBack(i);
+        unsafe.emplaceBack(i);
+    }
+    ASSERT_EQ(Tracked<true>::copies, 0);
+    ASSERT_GT(Tracked<true>::moves, 0);
+    ASSERT_EQ(Tracked<false>::moves, 0);
+    ASSERT_GT(Tracked<false>::copies, 0);
+
+    // A copy that throws halfway through growth leaves the vector as it was.
+    unsafe.shrinkToFit();
+    const Tracked<false>* data = unsafe.data();
+    Tracked<false>::resetCounters();
+    Tracked<false>::throw_on_copy = 50;
+    ASSERT_THROW(unsafe.emplaceBack(100), std::runtime_error);
+    ASSERT_EQ(unsafe.data(), data);
+    ASSERT_EQ(unsafe.size(), 100);
+    ASSERT_EQ(unsafe.capacity(), 100);
+    for (int i = 0; i < 100; i++)
+        ASSERT_EQ(unsafe[i].value, i);
+}
+
+TEST(Vector, TriviallyRelocatableTypesAreNotMovedOneByOne) {
+    {
+        task::vector<Relocatable, CustomAllocator<Relocatable>> actual;
+        Relocatable::moves = Relocatable::destructions = 0;
+        for (int i = 0; i < 1000; i++)
+            actual.emplaceBack(i);
+        actual.shrinkToFit();
+        ASSERT_EQ(Relocatable::moves, 0);
+        ASSERT_EQ(Relocatable::destructions, 0);
+        for (int i = 0; i < 1000; i++)
+            ASSERT_EQ(*actual[i].value, i);
+    }
+    ASSERT_EQ(Relocatable::destructions, 1000);
+}
+
+TEST(Vector, ReserveAndShrinkToFit) {
+    task::vector<int, StatsAllocator<std::allocator<int>>> actual;
+    actual.reserve(1000);
+    ASSERT_EQ(actual.capacity(), 1000);
+    for (int i = 0; i < 1000; i++)
+        actual.pushBack(i);
+    ASSERT_EQ(actual.getAllocator().stats().allocations, 1);
+
+    actual.reserve(10);
+    ASSERT_EQ(actual.capacity(), 1000);
+    actual.resize(10);
+    actual.shrinkToFit();
+    ASSERT_EQ(actual.capacity(), 10);
+    ASSERT_EQ(actual.back(), 9);
+    actual.clear();
+    actual.shrinkToFit();
+    ASSERT_EQ(actual.capacity(), 0);
+    ASSERT_EQ(actual.getAllocator().stats().live_bytes, 0);
+    ASSERT_THROW(actual.reserve(actual.maxSize() + 1), std::length_error);
+}
+
+namespace {
+
+// Default construction throws once `countdown` reaches zero.
+struct Bomb {
+    static int countdown;
+
+    Bomb() {
+        if (--countdown == 0)
+            throw std::runtime_error("boom");
+    }
+};
+
+int Bomb::countdown = 0;
+
+}  // namespace
+
+TEST(Vector, ThrowingCountConstructorFreesItsStorage) {
+    StatsAllocator<std::allocator<Bomb>> allocator;
+    Bomb::countdown = 3;
+    ASSERT_THROW((task::vector<Bomb, StatsAllocator<std::allocator<Bomb>>>(5, allocator)), std::runtime_error);
+    ASSERT_EQ(allocator.stats().allocations, 1);
+    ASSERT_EQ(allocator.stats().live_bytes, 0);
+}
+
+TEST(Vector, MoveAssignmentIsNoexceptOnlyWhenItCannotCopy) {
+    static_assert(std::is_nothrow_move_assignable_v<task::vector<std::string>>);
+    static_assert(!std::is_nothrow_move_assignable_v<task::vector<std::string, CustomAllocator<std::string>>>);
+
+    task::vector<std::string, CustomAllocator<std::string>> target;
+    task::vector<std::string, CustomAllocator<std::string>> source;
+    source.pushBack("moved one by one");
+    target = std::move(source);
+    ASSERT_EQ(target.front(), "moved one by one");
+}
+
+TEST(Vector, GrowthFactorIsConfigurable) {
+    task::vector<int, std::allocator<int>, std::ratio<3, 2>> actual;
+    std::vector<std::size_t> capacities;
+    for (int i = 0; i < 20; i++) {
+        actual.pushBack(i);
+        if (capacities.empty() || capacities.back() != actual.capacity())
+            capacities.push_back(actual.capacity());
+    }
+    std::vector<std::size_t> expected = {1, 2, 3, 4, 6, 9, 13, 19, 28};
+    ASSERT_EQ(capacities, expected);
+}
+
+TEST(Arena, GrowsPastFirstBlock) {
+    task::list<int, CustomAllocator<int>> actual;
+    std::list<int, CustomAllocator<int>> expected;
+
+    const int count = 1 << 18;
+    for (int i = 0; i < count; i++) {
+        actual.pushBack(i);
+        expected.push_back(i);
+    }
+    ASSERT_EQ(actual.size(), count);
+    ASSERT_TRUE(std::equal(actual.begin(), actual.end(), expected.begin(), expected.end()));
+
+    // Blocks double in size, so their number grows logarithmically.
+    CustomAllocator<int> allocator = actual.getAllocator();
+    ASSERT_GT(allocator.arena().capacity(), 2 * count * sizeof(int));
+    ASSERT_LE(allocator.arena().blockCount(), 16);
+}
+
+TEST(Arena, OversizedRequestGetsItsOwnBlock) {
+    CustomAllocator<char> allocator;
+    char* small = allocator.allocate(16);
+    char* large = allocator.allocate(detail::Arena::kFirstBlockSize * 4);
+    std::fill(large, large + detail::Arena::kFirstBlockSize * 4, 'x');
+    char* next = allocator.allocate(16);
+    ASSERT_EQ(allocator.arena().blockCount(), 3);
+    ASSERT_NE(small, next);
+}
+
+namespace {
+
+struct alignas(32) Wide {
+    char bytes[40];
+};
+
+struct Allocation {
+    unsigned char* begin;
+    std::size_t size;
+    unsigned char fill;
+};
+
+template <typename T>
+Allocation allocateFilled(const CustomAllocator<char>& arena, std::size_t n, unsigned char fill) {
+    typename CustomAllocator<char>::template rebind<T>::other allocator(arena);
+    T* p = allocator.allocate(n);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p) % alignof(T), 0u);
+    auto* begin = reinterpret_cast<unsigned char*>(p);
+    std::fill(begin, begin + n * sizeof(T), fill);
+    return {begin, n * sizeof(T), fill};
+}
+
+}  // namespace
+
+TEST(Arena, MixedTypeFuzz) {
+    std::mt19937 random_engine(12345);
+    std::uniform_int_distribution<int> type_distribution(0, 5);
+    std::uniform_int_distribution<std::size_t> count_distribution(1, 300);
+
+    CustomAllocator<char> arena;
+    std::vector<Allocation> allocations;
+    for (int i = 0; i < 20000; i++) {
+        std::size_t n = count_distribution(random_engine);
+        if (i % 1000 == 0)
+            n *= 1000;  // now and then something larger than a whole block
+        auto fill = static_cast<unsigned char>(i);
+        switch (type_distribution(random_engine)) {
+            case 0: allocations.push_back(allocateFilled<char>(arena, n, fill)); break;
+            case 1: allocations.push_back(allocateFilled<short>(arena, n, fill)); break;
+            case 2: allocations.push_back(allocateFilled<double>(arena, n, fill)); break;
+            case 3: allocations.push_back(allocateFilled<std::string>(arena, n, fill)); break;
+            case 4: allocations.push_back(allocateFilled<long double>(arena, n, fill)); break;
+            case 5: allocations.push_back(allocateFilled<Wide>(arena, n, fill)); break;
+        }
+    }
+
+    // Any overlap would have overwritten the fill of an earlier allocation.
+    for (const Allocation& allocation : allocations) {
+        ASSERT_TRUE(std::all_of(allocation.begin, allocation.begin + allocation.size,
+                                [&](unsigned char byte) { return byte == allocation.fill; }));
+    }
+}
+
+TEST(Arena, NodesAndValuesShareOneArena) {
+    task::list<std::string, CustomAllocator<std::string>> actual;
+    std::list<std::string, CustomAllocator<std::string>> expected(actual.getAllocator());
+    std::vector<double, CustomAllocator<double>> numbers(CustomAllocator<double>(actual.getAllocator()));
+
+    for (int i = 0; i < 1000; i++) {
+        actual.pushBack(std::string(i % 50, 'a' + i % 26));
+        expected.push_back(std::string(i % 50, 'a' + i % 26));
+        numbers.push_back(i * 0.5);
+    }
+    ASSERT_TRUE(std::equal(actual.begin(), actual.end(), expected.begin(), expected.end()));
+    for (int i = 0; i < 1000; i++)
+        ASSERT_EQ(numbers[i], i * 0.5);
+    ASSERT_TRUE(numbers.get_allocator() == actual.getAllocator());
+}
+
+TEST(Arena, ChurnRunsInConstantMemory) {
+    task::list<std::string, CustomAllocator<std::string>> actual;
+    std::list<std::string, CustomAllocator<std::string>> expected(actual.getAllocator());
+    for (int i = 0; i < 1000; i++) {
+        actual.pushBack("hello");
+        expected.push_back("hello");
+    }
+
+    CustomAllocator<std::string> allocator = actual.getAllocator();
+    const std::size_t warm_capacity = allocator.arena().capacity();
+    for (int i = 0; i < 1000000; i++) {
+        actual.pushBack("world");
+        actual.popFront();
+        expected.push_front("world");
+        expected.pop_back();
+    }
+    ASSERT_EQ(allocator.arena().capacity(), warm_capacity);
+    ASSERT_EQ(actual.size(), 1000);
+    ASSERT_EQ(expected.size(), 1000);
+}
+
+TEST(Arena, FreedChunksAreReusedBySizeClass) {
+    CustomAllocator<char> allocator;
+    typename CustomAllocator<char>::rebind<double>::other doubles(allocator);
+
+    double* first = doubles.allocate(5);
+    doubles.deallocate(first, 5);
+    // 40 and 33 bytes round up to the same class, 16 bytes do not.
+    char* same_class = allocator.allocate(33);
+    char* other_class = allocator.allocate(16);
+    ASSERT_EQ(static_cast<void*>(same_class), static_cast<void*>(first));
+    ASSERT_NE(static_cast<void*>(other_class), static_cast<void*>(first));
+}
+
+TEST(Arena, RewindDropsEverythingAfterTheMark) {
+    using List = task::list<int, CustomAllocator<int>>;
+    detail::Arena arena;
+    CustomAllocator<int> allocator(arena);
+    List kept(allocator);
+    for (int i = 0; i < 100; i++)
+        kept.pushBack(i);
+    const std::size_t kept_capacity = allocator.arena().capacity();
+
+    // Request-scoped lists live in the arena themselves and are never destroyed.
+    for (int request = 0; request < 3; request++) {
+        CustomAllocator<int>::Mark mark = allocator.mark();
+        typename CustomAllocator<int>::rebind<List>::other lists(allocator);
+        for (int i = 0; i < 10; i++) {
+            List* list = ::new(lists.allocate(1)) List(allocator);
+            for (int j = 0; j < 10000; j++)
+                list->pushBack(j);
+            ASSERT_EQ(list->back(), 9999);
+        }
+        ASSERT_GT(allocator.arena().capacity(), kept_capacity);
+        allocator.rewind(mark);
+        ASSERT_EQ(allocator.arena().capacity(), kept_capacity);
+    }
+
+    kept.pushBack(100);
+    std::vector<int> expected(101);
+    std::iota(expected.begin(), expected.end(), 0);
+    ASSERT_TRUE(std::equal(kept.begin(), kept.end(), expected.begin(), expected.end()));
+}
+
+TEST(Arena, RewindReusesTheSameMemory) {
+    CustomAllocator<char> allocator;
+    char* before = allocator.allocate(100);
+    CustomAllocator<char>::Mark mark = allocator.mark();
+    char* first = allocator.allocate(1000);
+    allocator.rewind(mark);
+    char* second = allocator.allocate(1000);
+    ASSERT_EQ(first, second);
+    ASSERT_NE(before, second);
+
+    allocator.reset();
+    ASSERT_EQ(allocator.arena().capacity(), 0);
+    ASSERT_EQ(allocator.arena().blockCount(), 0);
+    ASSERT_NE(allocator.allocate(10), nullptr);
+}
+
+TEST(MappedArena, RewindDecommits) {
+    detail::MappedArena arena;
+    arena.allocate(100);
+    const detail::MappedArena::Mark mark = arena.mark();
+    const std::size_t capacity = arena.capacity();
+
+    auto* big = static_cast<char*>(arena.allocate(3 * detail::MappedBlocks::kHugePageSize));
+    std::fill(big, big + 3 * detail::MappedBlocks::kHugePageSize, 'x');
+    ASSERT_GT(arena.capacity(), capacity);
+    arena.rewind(mark);
+    ASSERT_EQ(arena.capacity(), capacity);
+
+    // Recommitted pages come back zeroed.
+    auto* again = static_cast<char*>(arena.allocate(3 * detail::MappedBlocks::kHugePageSize));
+    ASSERT_EQ(again, big);
+    ASSERT_EQ(again[detail::MappedBlocks::kHugePageSize * 2], 0);
+}
+
+namespace {
+
+// Every thread churns its own list and hands half of its allocations to the
+// next thread to free, so chunks cross threads both ways.
+template <template <typename> class Allocator>
+void concurrentChurn() {
+    const int kThreads = 8;
+    const int kRounds = 20000;
+    Allocator<char> allocator;
+    std::vector<std::vector<std::pair<long*, long>>> handed_over(kThreads);
+    std::vector<std::mutex> mutexes(kThreads);
+    std::atomic<int> failures{0};
+    std::atomic<int> finished{0};
+
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < kThreads; thread++) {
+        threads.emplace_back([&, thread] {
+            typename Allocator<char>::template rebind<long>::other longs(allocator);
+            std::list<std::string, Allocator<std::string>> list{Allocator<std::string>(allocator)};
+            std::list<std::string> expected;
+            for (int i = 0; i < kRounds; i++) {
+                list.push_back(std::to_string(i));
+                expected.push_back(std::to_string(i));
+                if (i % 3 == 0) {
+                    list.pop_front();
+                    expected.pop_front();
+                }
+
+                std::size_t n = 1 + i % 7;
+                long* p = longs.allocate(n);
+                std::fill(p, p + n, static_cast<long>(thread) * kRounds + i);
+                std::lock_guard<std::mutex> lock(mutexes[(thread + 1) % kThreads]);
+                handed_over[(thread + 1) % kThreads].emplace_back(p, static_cast<long>(n));
+            }
+            if (!std::equal(list.begin(), list.end(), expected.begin(), expected.end()))
+                failures++;
+
+            finished++;
+            while (finished.load() != kThreads)
+                std::this_thread::yield();
+            std::lock_guard<std::mutex> lock(mutexes[thread]);
+            for (auto& [p, n] : handed_over[thread]) {
+                if (!std::all_of(p, p + n, [&](long value) { return value == p[0]; }))
+                    failures++;
+                longs.deallocate(p, n);
+            }
+            handed_over[thread].clear();
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    ASSERT_EQ(failures.load(), 0);
+}
+
+}  // namespace
+
+TEST(ConcurrentAllocator, ChurnFromManyThreads) {
+    concurrentChurn<ConcurrentAllocator>();
+}
+
+TEST(ThreadCachingAllocator, ChurnFromManyThreads) {
+    concurrentChurn<ThreadCachingAllocator>();
+}
+
+TEST(ConcurrentAllocator, WorksWithTaskList) {
+    task::list<std::string, ConcurrentAllocator<std::string>> actual;
+    task::list<std::string, ThreadCachingAllocator<std::string>> cached;
+    std::list<std::string> expected;
+    for (int i = 0; i < 1000; i++) {
+        actual.pushBack(std::to_string(i));
+        cached.pushFront(std::to_string(i));
+        expected.push_back(std::to_string(i));
+    }
+    ASSERT_TRUE(std::equal(actual.begin(), actual.end(), expected.begin(), expected.end()));
+    ASSERT_TRUE(std::equal(cached.begin(), cached.end(), expected.rbegin(), expected.rend()));
+}
+
+TEST(ConcurrentAllocator, MovedFromListsStayUsable) {
+    ConcurrentAllocator<int> allocator;
+    ConcurrentAllocator<int> moved(std::move(allocator));
+    ASSERT_TRUE(allocator == moved);
+
+    task::list<int, ConcurrentAllocator<int>> source;
+    source.pushBack(1);
+    task::list<int, ConcurrentAllocator<int>> target(std::move(source));
+    source.pushBack(2);
+    ASSERT_EQ(source.front(), 2);
+    ASSERT_EQ(target.front(), 1);
+
+    task::list<int, SlabAllocator<int>> slab_source;
+    task::list<int, SlabAllocator<int>> slab_target(std::move(slab_source));
+    slab_source.pushBack(3);
+    slab_target = std::move(slab_source);
+    slab_source.pushBack(4);
+    ASSERT_EQ(slab_target.back(), 3);
+    ASSERT_EQ(slab_source.back(), 4);
+}
+
+namespace {
+
+// Makes every allocation that misses the arena resource throw.
+class NoDefaultResource {
+public:
+    NoDefaultResource() : _previous(std::pmr::set_default_resource(std::pmr::null_memory_resource())) {}
+    ~NoDefaultResource() { std::pmr::set_default_resource(_previous); }
+
+private:
+    std::pmr::memory_resource* _previous;
+};
+
+}  // namespace
+
+TEST(ArenaResource, BacksStandardAndTaskContainers) {
+    MonotonicArenaResource resource;
+    NoDefaultResource guard;
+
+    std::pmr::vector<int> values(&resource);
+    task::list<int, std::pmr::polymorphic_allocator<int>> actual(&resource);
+    std::list<int> expected;
+    std::mt19937 random(42);
+    for (int i = 0; i < 1000; i++) {
+        int value = static_cast<int>(random() % 100);
+        values.push_back(value);
+        actual.pushBack(value);
+        expected.push_back(value);
+    }
+    actual.sort();
+    expected.sort();
+    actual.unique();
+    expected.unique();
+
+    ASSERT_TRUE(std::equal(actual.begin(), actual.end(), expected.begin(), expected.end()));
+    ASSERT_EQ(values.size(), 1000);
+    ASSERT_EQ(actual.getAllocator().resource(), &resource);
+    ASSERT_GT(resource.arena().capacity(), 0);
+}
+
+TEST(ArenaResource, PooledResourceRecyclesNodes) {
+    PooledArenaResource resource;
+    task::list<long, std::pmr::polymorphic_allocator<long>> list(&resource);
+    for (int i = 0; i < 1000; i++)
+        list.pushBack(i);
+    const std::size_t warm_capacity = resource.arena().capacity();
+
+    for (int i = 0; i < 100000; i++) {
+        list.pushBack(i);
+        list.popFront();
+    }
+    ASSERT_EQ(resource.arena().capacity(), warm_capacity);
+    ASSERT_EQ(list.size(), 1000);
+}
+
+TEST(ArenaResource, ListsKeepTheirOwnResource) {
+    PooledArenaResource first_resource;
+    PooledArenaResource second_resource;
+    using List = task::list<int, std::pmr::polymorphic_allocator<int>>;
+    List first(&first_resource);
+    List second(&second_resource);
+    List same(&first_resource);
+    for (int i = 0; i < 10; i++) {
+        first.pushBack(i);
+        second.pushBack(-i);
+    }
+
+    // Swapping needs equal resources, polymorphic_allocator never propagates.
+    ASSERT_THROW(first.swap(second), std::runtime_error);
+    first.swap(same);
+    ASSERT_EQ(first.size(), 0);
+    ASSERT_EQ(same.size(), 10);
+
+    // Moving between resources moves the elements, not the nodes.
+    List moved(std::move(same), List::allocator_type(&second_resource));
+    ASSERT_EQ(moved.getAllocator().resource(), &second_resource);
+    ASSERT_EQ(moved.size(), 10);
+    ASSERT_EQ(moved.back(), 9);
+
+    second = std::move(moved);
+    ASSERT_EQ(second.getAllocator().resource(), &second_resource);
+    ASSERT_EQ(second.front(), 0);
+}
+
+TEST(SlabAllocator, WorksWithTaskList) {
+    task::list<std::string, SlabAllocator<std::string>> actual;
+    std::list<std::string, SlabAllocator<std::string>> expected(actual.getAllocator());
+    for (int i = 0; i < 10000; i++) {
+        actual.pushBack(std::string(i % 100, 'a' + i % 26));
+        expected.push_back(std::string(i % 100, 'a' + i % 26));
+        if (i % 4 == 0) {
+            actual.popFront();
+            expected.pop_front();
+        }
+    }
+    actual.sort();
+    expected.sort();
+    ASSERT_TRUE(std::equal(actual.begin(), actual.end(), expected.begin(), expected.end()));
+}
+
+TEST(SlabAllocator, FreedObjectsAreReusedBySizeClass) {
+    SlabAllocator<char> allocator;
+    char* first = allocator.allocate(100);
+    allocator.deallocate(first, 100);
+    // 100 and 120 bytes share the 128 byte class, 140 bytes do not.
+    char* same_class = allocator.allocate(120);
+    char* other_class = allocator.allocate(140);
+    ASSERT_EQ(same_class, first);
+    ASSERT_NE(other_class, first);
+    ASSERT_EQ(allocator.arena().slabCount(detail::SlabHeap::sizeClass(100)), 1);
+    ASSERT_EQ(allocator.arena().slabCount(detail::SlabHeap::sizeClass(140)), 1);
+}
+
+TEST(SlabAllocator, LargeRequestsBypassTheSlabs) {
+    SlabAllocator<char> allocator;
+    typename SlabAllocator<char>::rebind<Wide>::other wide(allocator);
+    const std::size_t large = detail::SlabHeap::kMaxSlabObject + 1;
+
+    char* p = allocator.allocate(large);
+    Wide* w = wide.allocate(1);
+    std::fill(p, p + large, 'x');
+    ASSERT_EQ(reinterpret_cast<std::uintptr_t>(w) % alignof(Wide), 0u);
+    ASSERT_EQ(allocator.arena().capacity(), 0);
+    allocator.deallocate(p, large);
+    wide.deallocate(w, 1);
+}
+
+TEST(SlabAllocator, MixedSizeFuzz) {
+    std::mt19937 random_engine(54321);
+    std::uniform_int_distribution<std::size_t> size_distribution(1, 3000);
+    SlabAllocator<unsigned char> allocator;
+    std::vector<Allocation> live;
+
+    for (int i = 0; i < 50000; i++) {
+        if (!live.empty() && random_engine() % 3 == 0) {
+            std::size_t victim = random_engine() % live.size();
+            Allocation allocation = live[victim];
+            ASSERT_TRUE(std::all_of(allocation.begin, allocation.begin + allocation.size,
+                                    [&](unsigned char byte) { return byte == allocation.fill; }));
+            allocator.deallocate(allocation.begin, allocation.size);
+            live[victim] = live.back();
+            live.pop_back();
+            continue;
+        }
+        std::size_t size = size_distribution(random_engine);
+        auto fill = static_cast<unsigned char>(i);
+        unsigned char* p = allocator.allocate(size);
+        ASSERT_EQ(reinterpret_cast<std::uintptr_t>(p) % alignof(std::max_align_t), 0u);
+        std::fill(p, p + size, fill);
+        live.push_back({p, size, fill});
+    }
+    for (const Allocation& allocation : live) {
+        ASSERT_TRUE(std::all_of(allocation.begin, allocation.begin + allocation.size,
+                                [&](unsigned char byte) { return byte == allocation.fill; }));
+        allocator.deallocate(allocation.begin, allocation.size);
+    }
+}
+
+TEST(StatsAllocator, CountsListAllocations) {
+    using Allocator = StatsAllocator<CustomAllocator<std::string>, true>;
+    task::list<std::string, Allocator> actual;
+    for (int i = 0; i < 100; i++)
+        actual.pushBack(std::to_string(i));
+    for (int i = 0; i < 40; i++)
+        actual.popFront();
+
+    // One node per element, all of one size; the sentinel lives in the list.
+    const AllocationStats& stats = actual.getAllocator().stats();
+    ASSERT_EQ(stats.allocations, 100);
+    ASSERT_EQ(stats.deallocations, 40);
+    ASSERT_EQ(stats.bytes_allocated, 100 * (stats.bytes_allocated / 100));
+    ASSERT_EQ(stats.live_bytes, 60 * (stats.bytes_allocated / 100));
+    ASSERT_EQ(stats.peak_bytes, stats.bytes_allocated);
+    ASSERT_EQ(std::count_if(stats.size_histogram.begin(), stats.size_histogram.end(),
+                            [](std::size_t count) { return count != 0; }), 1);
+    std::size_t lifetimes = 0;
+    for (std::size_t count : stats.lifetime_histogram)
+        lifetimes += count;
+    ASSERT_EQ(lifetimes, 40);
+}
+
+TEST(StatsAllocator, CopiesAndRebindsShareStats) {
+    StatsAllocator<std::allocator<char>, true> chars;
+    typename StatsAllocator<std::allocator<char>, true>::rebind<double>::other doubles(chars);
+    std::vector<int, StatsAllocator<std::allocator<int>, true>> numbers{
+        StatsAllocator<std::allocator<int>, true>(chars)};
+
+    doubles.deallocate(doubles.allocate(4), 4);
+    chars.deallocate(chars.allocate(1000), 1000);
+    numbers.push_back(1);
+    ASSERT_EQ(chars.stats().allocations, 3);
+    ASSERT_EQ(chars.stats().deallocations, 2);
+    ASSERT_EQ(chars.stats().peak_bytes, 1000);
+    ASSERT_EQ(chars.stats().size_histogram[AllocationStats::bucket(32)], 1);
+    ASSERT_EQ(chars.stats().size_histogram[AllocationStats::bucket(1000)], 1);
+
+    std::ostringstream report;
+    chars.report(report);
+    ASSERT_NE(report.str().find("peak bytes:    1000"), std::string::npos);
+    ASSERT_NE(report.str().find("[512, 1024) bytes: 1"), std::string::npos);
+}
+
+namespace {
+
+// std::allocator, except that it returns null for empty requests.
+template <typename T>
+struct NullForEmptyAllocator : std::allocator<T> {
+    template <typename U>
+    struct rebind {  // NOLINT
+        using other = NullForEmptyAllocator<U>;
+    };
+
+    NullForEmptyAllocator() = default;
+    template <typename U>
+    NullForEmptyAllocator(const NullForEmptyAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) { return n == 0 ? nullptr : std::allocator<T>::allocate(n); }
+    void deallocate(T* p, std::size_t n) {
+        if (p != nullptr)
+            std::allocator<T>::deallocate(p, n);
+    }
+};
+
+}  // namespace
+
+TEST(StatsAllocator, MovedFromAllocatorKeepsRecording) {
+    StatsAllocator<std::allocator<int>> allocator;
+    StatsAllocator<std::allocator<int>> moved(std::move(allocator));
+    ASSERT_TRUE(allocator == moved);
+    int* p = allocator.allocate(4);
+    allocator.deallocate(p, 4);
+    allocator = std::move(moved);
+    p = moved.allocate(1);
+    moved.deallocate(p, 1);
+    ASSERT_EQ(allocator.stats().allocations, 2);
+    ASSERT_EQ(&moved.stats(), &allocator.stats());
+}
+
+TEST(StatsAllocator, NullAllocationsAreNotRecorded) {
+    StatsAllocator<NullForEmptyAllocator<int>> allocator;
+    int* p = allocator.allocate(0);
+    ASSERT_EQ(p, nullptr);
+    allocator.deallocate(p, 0);
+    p = allocator.allocate(2);
+    allocator.deallocate(p, 2);
+    ASSERT_EQ(allocator.stats().allocations, 1);
+    ASSERT_EQ(allocator.stats().deallocations, 1);
+    ASSERT_EQ(allocator.stats().live_bytes, 0);
+}
+
+TEST(StatsAllocator, NodesOnlyMoveBetweenListsWithTheSameStats) {
+    using List = task::list<int, StatsAllocator<std::allocator<int>>>;
+    List first;
+    List second;
+    second.pushBack(1);
+    second.pushBack(2);
+    ASSERT_FALSE(first.getAllocator() == second.getAllocator());
+    ASSERT_THROW(first.splice(first.end(), second), std::runtime_error);
+    ASSERT_THROW(first.merge(second), std::runtime_error);
+    ASSERT_EQ(second.size(), 2);
+
+    List shared(second.getAllocator());
+    shared.splice(shared.end(), second);
+    ASSERT_EQ(shared.size(), 2);
+    first.pushBack(3);
+    first.clear();
+    shared.clear();
+    ASSERT_EQ(first.getAllocator().stats().live_bytes, 0);
+    ASSERT_EQ(first.getAllocator().stats().deallocations, 1);
+    ASSERT_EQ(second.getAllocator().stats().live_bytes, 0);
+    ASSERT_EQ(second.getAllocator().stats().deallocations, 2);
+}
+
+TEST(StatsAllocator, DisabledWrapperIsFree) {
+    using Disabled = StatsAllocator<CustomAllocator<int>, false>;
+    static_assert(sizeof(Disabled) == sizeof(CustomAllocator<int>));
+    static_assert(sizeof(task::list<int, Disabled>) == sizeof(task::list<int, CustomAllocator<int>>));
+
+    task::list<int, Disabled> actual;
+    for (int i = 0; i < 100; i++)
+        actual.pushBack(i);
+    ASSERT_EQ(actual.getAllocator().stats().allocations, 0);
+    ASSERT_EQ(actual.size(), 100);
+}
+
+TEST(MappedArena, GrowsInPlaceInHugePages) {
+    task::list<int, MappedAllocator<int>> actual;
+    std::list<int> expected;
+    for (int i = 0; i < 1 << 18; i++) {
+        actual.pushBack(i);
+        expected.push_back(i);
+    }
+    ASSERT_TRUE(std::equal(actual.begin(), actual.end(), expected.begin(), expected.end()));
+
+    const detail::MappedArena& arena = MappedAllocator<int>(actual.getAllocator()).arena();
+    ASSERT_EQ(arena.capacity() % detail::MappedBlocks::kHugePageSize, 0);
+    ASSERT_GE(arena.capacity(), (std::size_t(1) << 18) * 2 * sizeof(int));
+    ASSERT_LE(arena.blockCount(), 8);
+}
+
+TEST(MappedArena, PrefaultedArenaWorksWithTaskList) {
+    auto arena = std::make_shared<detail::MappedArena>(
+        detail::MappedBlocks::kHugePageSize, detail::MappedBlocks(std::size_t(1) << 30, true));
+    task::list<std::string, MappedAllocator<std::string>> actual{MappedAllocator<std::string>(arena)};
+    for (int i = 0; i < 10000; i++)
+        actual.pushFront(std::to_string(i));
+    ASSERT_EQ(actual.front(), "9999");
+    ASSERT_EQ(arena->capacity(), detail::MappedBlocks::kHugePageSize);
+}
+
+TEST(MappedArena, ChainsAnotherReservationWhenFull) {
+    auto arena = std::make_shared<detail::MappedArena>(
+        detail::MappedArena::kFirstBlockSize, detail::MappedBlocks(4 * detail::MappedBlocks::kHugePageSize));
+    MappedAllocator<char> allocator(arena);
+    char* first = allocator.allocate(3 * detail::MappedBlocks::kHugePageSize);
+    std::fill(first, first + 3 * detail::MappedBlocks::kHugePageSize, 'x');
+    const detail::MappedArena::Mark mark = arena->mark();
+    ASSERT_EQ(arena->source().rangeCount(), 1);
+
+    char* second = allocator.allocate(2 * detail::MappedBlocks::kHugePageSize);
+    std::fill(second, second + 2 * detail::MappedBlocks::kHugePageSize, 'y');
+    ASSERT_EQ(arena->source().rangeCount(), 2);
+    ASSERT_EQ(arena->source().reservation(), 12 * detail::MappedBlocks::kHugePageSize);
+    ASSERT_EQ(first[0], 'x');
+
+    arena->rewind(mark);
+    ASSERT_EQ(arena->source().rangeCount(), 1);
+    ASSERT_EQ(first[3 * detail::MappedBlocks::kHugePageSize - 1], 'x');
+    ASSERT_NE(allocator.allocate(16), nullptr);
+}
+
+TEST(MappedArena, DefaultReservationIsModest) {
+    detail::MappedArena arena;
+    ASSERT_LE(arena.source().reservation(), std::size_t(1) << 30);
+}
+
+TEST(ShortAllocator, SmallListsStayOffTheHeap) {
+    StackArena<2048> arena;
+    {
+        using Allocator = ShortAllocator<int, 2048>;
+        task::list<int, Allocator> actual{Allocator(arena)};
+        task::list<int, Allocator> copy{Allocator(arena)};
+        for (int i = 0; i < 32; i++)
+            actual.pushFront(i);
+        copy = actual;
+        actual.popBack();
+        actual.sort();
+        ASSERT_EQ(actual.back(), 31);
+        ASSERT_EQ(copy.back(), 0);
+        ASSERT_EQ(copy.size(), 32);
+    }
+    ASSERT_EQ(arena.spills(), 0);
+    ASSERT_GT(arena.used(), 0);
+}
+
+TEST(ShortAllocator, SpillsToTheHeapWhenFull) {
+    StackArena<256> arena;
+    using Allocator = ShortAllocator<std::string, 256>;
+    task::list<std::string, Allocator> actual{Allocator(arena)};
+    std::list<std::string, Allocator> expected{Allocator(arena)};
+    for (int i = 0; i < 100; i++) {
+        actual.pushBack(std::to_string(i));
+        expected.push_back(std::to_string(i));
+    }
+    ASSERT_TRUE(std::equal(actual.begin(), actual.end(), expected.begin(), expected.end()));
+    ASSERT_LE(arena.used(), arena.size());
+    ASSERT_GT(arena.spills(), 0);
+}
+
+TEST(ShortAllocator, LastAllocationIsGivenBack) {
+    StackArena<128> arena;
+    ShortAllocator<char, 128> chars(arena);
+    ShortAllocator<Wide, 128> wide(chars);
+
+    char* first = chars.allocate(10);
+    char* second = chars.allocate(20);
+    chars.deallocate(second, 20);
+    ASSERT_EQ(arena.used(), 10);
+    chars.deallocate(first, 10);
+    ASSERT_EQ(arena.used(), 0);
+
+    Wide* aligned = wide.allocate(1);
+    ASSERT_TRUE(arena.owns(aligned));
+    ASSERT_EQ(reinterpret_cast<std::uintptr_t>(aligned) % alignof(Wide), 0u);
+
+    Wide* spilled = wide.allocate(4);
+    ASSERT_FALSE(arena.owns(spilled));
+    ASSERT_EQ(reinterpret_cast<std::uintptr_t>(spilled) % alignof(Wide), 0u);
+    wide.deallocate(spilled, 4);
+}
+
+TEST(ScopedAllocator, NestedContainersShareTheArena) {
+    detail::Arena arena;
+    CustomAllocator<int> in_arena(arena);
+    using Row = std::vector<int, CustomAllocator<int>>;
+    task::list<Row, ScopedCustomAllocator<Row>> rows{ScopedCustomAllocator<Row>(arena)};
+
+    rows.emplaceBack();
+    for (int i = 0; i < 1000; i++)
+        rows.back().push_back(i);
+    rows.emplaceBack(5, 7);
+    rows.resize(3);
+    std::size_t capacity = arena.capacity();
+    ASSERT_GE(capacity, 1000 * sizeof(int));
+
+    Row elsewhere = {1, 2, 3};
+    rows.pushBack(elsewhere);
+    rows.pushFront(std::move(elsewhere));
+    for (const Row& row : rows)
+        ASSERT_TRUE(row.get_allocator() == in_arena);
+    ASSERT_EQ(rows.back(), (Row{{1, 2, 3}, in_arena}));
+
+    task::list<Row, ScopedCustomAllocator<Row>> copy(rows, ScopedCustomAllocator<Row>(arena));
+    ASSERT_TRUE(copy.front().get_allocator() == in_arena);
+    ASSERT_EQ((++copy.begin())->size(), 1000);
+}
+
+TEST(ScopedAllocator, PolymorphicAllocatorsPropagateToTaskContainers) {
+    PooledArenaResource resource;
+    using Row = task::vector<int, std::pmr::polymorphic_allocator<int>>;
+    task::list<Row, std::pmr::polymorphic_allocator<Row>> rows(&resource);
+    rows.emplaceBack(10);
+    rows.resize(2);
+    rows.back().pushBack(42);
+    task::list<std::pmr::vector<int>, std::pmr::polymorphic_allocator<std::pmr::vector<int>>> std_rows(&resource);
+    std_rows.emplaceBack(3, 1);
+
+    for (const Row& row : rows)
+        ASSERT_EQ(row.getAllocator().resource(), &resource);
+    ASSERT_EQ(rows.front().size(), 10);
+    ASSERT_EQ(std_rows.front().get_allocator().resource(), &resource);
+    ASSERT_GT(resource.arena().capacity(), 0);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
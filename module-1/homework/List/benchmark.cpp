@@ -0,0 +1,394 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "concurrent_deque.h"
+#include "list.h"
+#include "unrolled_list.h"
+#include "xor_list.h"
+
+// std::list<int> allocates every node with new/delete, which is exactly what
+// task::list did before the node pool, so it doubles as the baseline.
+
+
+template <class F>
+double MeasureMs(F &&body) {
+    auto start = std::chrono::steady_clock::now();
+    body();
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+
+void Report(const std::string &name, double task_ms, double std_ms) {
+    std::cout << std::left << std::setw(28) << name
+              << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << task_ms
+              << std::setw(12) << std_ms
+              << std::setw(10) << std_ms / task_ms << "x\n";
+}
+
+
+template <class Container>
+long long Sum(const Container &container, size_t rounds) {
+    long long sum = 0;
+    for (size_t round = 0; round < rounds; ++round)
+        sum += std::accumulate(container.begin(), container.end(), 0LL);
+    return sum;
+}
+
+
+template <class Container>
+Container Filled(size_t count, int modulo) {
+    Container container;
+    for (size_t i = 0; i < count; ++i)
+        container.push_back(static_cast<int>(i * 7919 % modulo));
+    return container;
+}
+
+
+template <class Container>
+void RemoveEach(Container &container, int modulo) {
+    for (int value = 0; value < modulo; ++value)
+        container.remove(value);
+}
+
+
+template <>
+void RemoveEach(std::vector<int> &container, int modulo) {
+    for (int value = 0; value < modulo; ++value)
+        container.erase(std::remove(container.begin(), container.end(), value), container.end());
+}
+
+
+template <class List>
+void SortAndMerge(size_t count) {
+    List first = Filled<List>(count, 1 << 30);
+    List second = Filled<List>(count / 2, 1 << 20);
+    first.sort();
+    second.sort();
+    first.merge(second);
+}
+
+
+template <class List>
+List Input(const std::string &kind, size_t count) {
+    List list;
+    unsigned state = 12345;
+    for (size_t i = 0; i < count; ++i) {
+        state = state * 1103515245u + 12345u;
+        if (kind == "random")
+            list.push_back(static_cast<int>(state));
+        else if (kind == "sorted")
+            list.push_back(static_cast<int>(i) - static_cast<int>(count / 2));
+        else
+            list.push_back(static_cast<int>(state >> 16) % 16 - 8);
+    }
+    return list;
+}
+
+
+template <class List>
+void CopyAndAssign(size_t count, size_t rounds) {
+    List source(count, 1);
+    List target(count / 2, 2);
+    for (size_t round = 0; round < rounds; ++round) {
+        List copy(source);
+        target = copy;
+        target.assign(count, static_cast<int>(round));
+        std::vector<List> moved;
+        moved.push_back(std::move(copy));
+        moved.push_back(std::move(target));
+        target = std::move(moved.back());
+    }
+}
+
+
+// The work queue setup that concurrent_deque replaces: one mutex around a list.
+class LockedList {
+public:
+    void push_back(int value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        list_.push_back(value);
+    }
+
+    bool pop_front(int &value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (list_.empty())
+            return false;
+        value = list_.front();
+        list_.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    task::list list_;
+};
+
+
+// Half of the threads produce at the back, half consume at the front.
+template <class Queue>
+void WorkQueue(size_t threads, size_t ops) {
+    Queue queue;
+    for (int i = 0; i < 1024; ++i)
+        queue.push_back(i);
+    std::vector<std::thread> workers;
+    for (size_t thread = 0; thread < threads; ++thread) {
+        workers.emplace_back([&queue, thread, threads, ops] {
+            int value;
+            for (size_t i = 0; i < ops / threads; ++i) {
+                if (thread % 2 == 0 || threads == 1)
+                    queue.push_back(static_cast<int>(i));
+                if (thread % 2 == 1 || threads == 1)
+                    queue.pop_front(value);
+            }
+        });
+    }
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+
+template <class List>
+void BuildAndClear(size_t count, size_t rounds) {
+    List list;
+    for (size_t round = 0; round < rounds; ++round) {
+        for (size_t i = 0; i < count; ++i)
+            list.push_back(static_cast<int>(i));
+        list.clear();
+    }
+}
+
+
+template <class List>
+void Churn(size_t count, size_t ops) {
+    List list;
+    for (size_t i = 0; i < count; ++i)
+        list.push_back(static_cast<int>(i));
+    for (size_t i = 0; i < ops; ++i) {
+        list.push_back(static_cast<int>(i));
+        list.pop_front();
+    }
+}
+
+
+template <class List>
+void Deque(size_t ops) {
+    List list;
+    for (size_t i = 0; i < ops; ++i) {
+        list.push_front(static_cast<int>(i));
+        if (i % 3 == 2) {
+            list.pop_back();
+            list.pop_back();
+        }
+    }
+}
+
+
+template <class List>
+void Remove(size_t count, int modulo) {
+    List list;
+    for (size_t i = 0; i < count; ++i)
+        list.push_back(static_cast<int>(i % modulo));
+    for (int value = 0; value < modulo; ++value)
+        list.remove(value);
+}
+
+
+// Wide filters: every second element, then all but one of every ten.
+template <class List>
+void Filter(size_t count) {
+    List list;
+    for (size_t i = 0; i < count; ++i)
+        list.push_back(static_cast<int>(i * 7919 % 1000));
+    list.remove_if([](int value) { return value % 2 == 0; });
+    List runs;
+    for (size_t i = 0; i < count; ++i)
+        runs.push_back(static_cast<int>(i));
+    runs.unique([](int first, int second) { return first / 10 == second / 10; });
+}
+
+
+// Positional reads and inserts at pseudo-random positions; std::list has to walk.
+size_t Position(size_t i, size_t size) {
+    return static_cast<size_t>(i * 2654435761u) % (size + 1);
+}
+
+
+void Positional(task::list &list, size_t ops, volatile long long &sink) {
+    for (size_t i = 0; i < ops; ++i) {
+        list.insert_at(Position(i, list.size()), static_cast<int>(i));
+        sink = sink + list.at(Position(i, list.size() - 1));
+    }
+}
+
+
+void Positional(std::list<int> &list, size_t ops, volatile long long &sink) {
+    for (size_t i = 0; i < ops; ++i) {
+        list.insert(std::next(list.begin(), Position(i, list.size())), static_cast<int>(i));
+        sink = sink + *std::next(list.begin(), Position(i, list.size() - 1));
+    }
+}
+
+
+int main(int argc, char **argv) {
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+    std::cout << "elements: " << count << "\n";
+    std::cout << std::left << std::setw(28) << "workload"
+              << std::right << std::setw(12) << "task, ms"
+              << std::setw(12) << "std, ms"
+              << std::setw(11) << "speedup" << "\n";
+
+    Report("build + clear (x10)",
+           MeasureMs([&] { BuildAndClear<task::list>(count, 10); }),
+           MeasureMs([&] { BuildAndClear<std::list<int>>(count, 10); }));
+    Report("push_back / pop_front churn",
+           MeasureMs([&] { Churn<task::list>(count / 10, count * 10); }),
+           MeasureMs([&] { Churn<std::list<int>>(count / 10, count * 10); }));
+    Report("push_front / pop_back",
+           MeasureMs([&] { Deque<task::list>(count * 10); }),
+           MeasureMs([&] { Deque<std::list<int>>(count * 10); }));
+    Report("remove (16 values)",
+           MeasureMs([&] { Remove<task::list>(count, 16); }),
+           MeasureMs([&] { Remove<std::list<int>>(count, 16); }));
+    Report("remove_if + unique(pred)",
+           MeasureMs([&] { Filter<task::list>(count); }),
+           MeasureMs([&] { Filter<std::list<int>>(count); }));
+    Report("copy, assign, move (x10)",
+           MeasureMs([&] { CopyAndAssign<task::list>(count, 10); }),
+           MeasureMs([&] { CopyAndAssign<std::list<int>>(count, 10); }));
+    Report("build, sort, merge",
+           MeasureMs([&] { SortAndMerge<task::list>(count); }),
+           MeasureMs([&] { SortAndMerge<std::list<int>>(count); }));
+
+    {
+        auto positional_task = Filled<task::list>(count, 1 << 30);
+        auto positional_std = Filled<std::list<int>>(count, 1 << 30);
+        volatile long long positional_sink = 0;
+        Report("insert_at + at (1000 ops)",
+               MeasureMs([&] { Positional(positional_task, 1000, positional_sink); }),
+               MeasureMs([&] { Positional(positional_std, 1000, positional_sink); }));
+    }
+
+    std::cout << "\n" << std::left << std::setw(28) << "sort, ms"
+              << std::right << std::setw(12) << "sort"
+              << std::setw(12) << "radix_sort"
+              << std::setw(12) << "std::list" << "\n";
+    for (const std::string kind : {"random", "sorted", "few unique"}) {
+        auto merge_input = Input<task::list>(kind, count);
+        auto radix_input = Input<task::list>(kind, count);
+        auto std_input = Input<std::list<int>>(kind, count);
+        std::cout << std::left << std::setw(28) << kind
+                  << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << MeasureMs([&] { merge_input.sort(); })
+                  << std::setw(12) << MeasureMs([&] { radix_input.radix_sort(); })
+                  << std::setw(12) << MeasureMs([&] { std_input.sort(); }) << "\n";
+    }
+
+    std::cout << "\n" << std::left << std::setw(28) << "parallel_sort, random"
+              << std::right << std::setw(12) << "ms"
+              << std::setw(12) << "speedup" << "\n";
+    double single_ms = 0;
+    for (size_t threads : {1, 2, 4, 8, 16}) {
+        auto input = Input<task::list>("random", count);
+        double ms = MeasureMs([&] { input.parallel_sort(threads); });
+        if (threads == 1)
+            single_ms = ms;
+        std::cout << std::left << std::setw(28) << std::to_string(threads) + " threads"
+                  << std::right << std::setw(12) << ms
+                  << std::setw(12) << single_ms / ms << "\n";
+    }
+
+    std::cout << "\n" << std::left << std::setw(28) << "work queue, ms"
+              << std::right << std::setw(12) << "deque"
+              << std::setw(12) << "locked list" << "\n";
+    for (size_t threads : {1, 2, 4, 8, 16}) {
+        std::cout << std::left << std::setw(28) << std::to_string(threads) + " threads"
+                  << std::right
+                  << std::setw(12) << MeasureMs([&] { WorkQueue<task::concurrent_deque>(threads, count * 4); })
+                  << std::setw(12) << MeasureMs([&] { WorkQueue<LockedList>(threads, count * 4); })
+                  << "\n";
+    }
+
+    std::cout << "\n" << std::left << std::setw(28) << "unrolled_list"
+              << std::right << std::setw(12) << "unrolled"
+              << std::setw(12) << "std::list"
+              << std::setw(12) << "vector" << "\n";
+
+    auto unrolled = Filled<task::unrolled_list>(count, 1024);
+    auto list = Filled<std::list<int>>(count, 1024);
+    auto vector = Filled<std::vector<int>>(count, 1024);
+    volatile long long sink = 0;
+
+    std::cout << std::left << std::setw(28) << "iterate (x10), ms"
+              << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << MeasureMs([&] { sink = sink + Sum(unrolled, 10); })
+              << std::setw(12) << MeasureMs([&] { sink = sink + Sum(list, 10); })
+              << std::setw(12) << MeasureMs([&] { sink = sink + Sum(vector, 10); }) << "\n";
+    std::cout << std::left << std::setw(28) << "remove (64 values), ms"
+              << std::right
+              << std::setw(12) << MeasureMs([&] { RemoveEach(unrolled, 64); })
+              << std::setw(12) << MeasureMs([&] { RemoveEach(list, 64); })
+              << std::setw(12) << MeasureMs([&] { RemoveEach(vector, 64); }) << "\n";
+
+    auto fresh = Filled<task::unrolled_list>(count, 1024);
+    std::cout << std::left << std::setw(28) << "bytes per element"
+              << std::right
+              << std::setw(12) << static_cast<double>(fresh.memory_usage()) / count
+              << std::setw(12) << "-"
+              << std::setw(12) << static_cast<double>(sizeof(int)) << "\n";
+
+    // Memory per element is independent of the count once the pool has reached its
+    // largest chunk size, so the 10^8 column is projected from `count` elements.
+    // Pass 100000000 as the argument to measure it directly.
+    std::cout << "\n" << std::left << std::setw(28) << "node layout"
+              << std::right << std::setw(12) << "list"
+              << std::setw(12) << "xor_list"
+              << std::setw(12) << "unrolled" << "\n";
+
+    task::list pooled_list;
+    task::xor_list xor_list;
+    task::unrolled_list unrolled_list;
+    std::cout << std::left << std::setw(28) << "build, ms"
+              << std::right
+              << std::setw(12) << MeasureMs([&] { pooled_list = Filled<task::list>(count, 1 << 30); })
+              << std::setw(12) << MeasureMs([&] { xor_list = Filled<task::xor_list>(count, 1 << 30); })
+              << std::setw(12) << MeasureMs([&] { unrolled_list = Filled<task::unrolled_list>(count, 1 << 30); })
+              << "\n";
+    std::cout << std::left << std::setw(28) << "iterate (x10), ms"
+              << std::right
+              << std::setw(12) << MeasureMs([&] { sink = sink + Sum(pooled_list, 10); })
+              << std::setw(12) << MeasureMs([&] { sink = sink + Sum(xor_list, 10); })
+              << std::setw(12) << MeasureMs([&] { sink = sink + Sum(unrolled_list, 10); }) << "\n";
+    std::cout << std::left << std::setw(28) << "sort, ms"
+              << std::right
+              << std::setw(12) << MeasureMs([&] { pooled_list.sort(); })
+              << std::setw(12) << MeasureMs([&] { xor_list.sort(); })
+              << std::setw(12) << MeasureMs([&] { unrolled_list.sort(); }) << "\n";
+
+    const double list_bytes = static_cast<double>(pooled_list.memory_usage()) / count;
+    const double xor_bytes = static_cast<double>(xor_list.memory_usage()) / count;
+    const double unrolled_bytes = static_cast<double>(unrolled_list.memory_usage()) / count;
+    std::cout << std::left << std::setw(28) << "bytes per element"
+              << std::right
+              << std::setw(12) << list_bytes
+              << std::setw(12) << xor_bytes
+              << std::setw(12) << unrolled_bytes << "\n";
+    std::cout << std::left << std::setw(28) << "10^8 elements, GiB"
+              << std::right
+              << std::setw(12) << list_bytes * 1e8 / (1 << 30)
+              << std::setw(12) << xor_bytes * 1e8 / (1 << 30)
+              << std::setw(12) << unrolled_bytes * 1e8 / (1 << 30) << "\n";
+
+    return 0;
+}
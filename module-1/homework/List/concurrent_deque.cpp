@@ -0,0 +1,189 @@
+#include "concurrent_deque.h"
+
+using namespace task;
+
+const size_t concurrent_deque::kTwoLockMinSize;
+
+
+class concurrent_deque::Guard {
+public:
+    Guard(concurrent_deque &deque, End end)
+        : head_(deque.head_mutex_, std::defer_lock),
+          tail_(deque.tail_mutex_, std::defer_lock) {
+        std::unique_lock<std::mutex> &own = end == End::kFront ? head_ : tail_;
+        own.lock();
+        // Every earlier operation on this end is already counted in size_, and the
+        // other end can only shrink the deque below the limit by taking our lock.
+        if (deque.size_.load() >= kTwoLockMinSize)
+            return;
+        own.unlock();
+        head_.lock();
+        tail_.lock();
+    }
+
+private:
+    std::unique_lock<std::mutex> head_;
+    std::unique_lock<std::mutex> tail_;
+};
+
+
+// Pushes take nodes from the cache of their thread and pops give them back, so
+// nodes are recycled without another lock and without new/delete. In a
+// work queue one thread pops what another pushed, so nodes have to travel: a
+// cache that has collected kBatch nodes hands them to a shared stack in one
+// push, and a cache that runs dry takes the whole stack with one exchange. The
+// stack is never popped node by node, which keeps it free of the ABA problem.
+class concurrent_deque::NodeCache {
+public:
+    static const size_t kBatch = 256;
+
+    static NodeCache &local() {
+        static thread_local NodeCache cache;
+        return cache;
+    }
+
+    ~NodeCache() {
+        Delete(free_);
+    }
+
+    Node *take(int value, Node *prev, Node *next) {
+        if (free_ == nullptr)
+            free_ = shared().exchange(nullptr, std::memory_order_acquire);
+        if (free_ == nullptr)
+            return new Node{value, prev, next};
+
+        Node *node = free_;
+        free_ = node->next;
+        if (counted_ != 0)
+            counted_--;
+        *node = Node{value, prev, next};
+        return node;
+    }
+
+    void put(Node *node) {
+        node->next = free_;
+        free_ = node;
+        // The counted nodes sit on top of free_, above whatever came from the stack.
+        if (counted_++ == 0)
+            bottom_ = node;
+        if (counted_ < kBatch)
+            return;
+
+        Node *rest = bottom_->next;
+        std::atomic<Node *> &stack = shared();
+        Node *head = stack.load(std::memory_order_relaxed);
+        do {
+            bottom_->next = head;
+        } while (!stack.compare_exchange_weak(head, free_, std::memory_order_release,
+                                              std::memory_order_relaxed));
+        free_ = rest;
+        counted_ = 0;
+    }
+
+private:
+    // Frees the nodes left on the stack once the program exits.
+    struct SharedStack {
+        std::atomic<Node *> head{nullptr};
+
+        ~SharedStack() {
+            Delete(head.load());
+        }
+    };
+
+    static std::atomic<Node *> &shared() {
+        static SharedStack stack;
+        return stack.head;
+    }
+
+    static void Delete(Node *node) {
+        while (node != nullptr) {
+            Node *next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    Node *free_ = nullptr;
+    Node *bottom_ = nullptr;  // lowest counted node, valid while counted_ != 0
+    size_t counted_ = 0;
+};
+
+const size_t concurrent_deque::NodeCache::kBatch;
+
+
+concurrent_deque::concurrent_deque() {
+    NIL->prev = NIL;
+    NIL->next = NIL;
+}
+
+concurrent_deque::~concurrent_deque() {
+    Node *tmp = NIL->next;
+    while (tmp != NIL) {
+        Node *next = tmp->next;
+        delete tmp;
+        tmp = next;
+    }
+}
+
+void concurrent_deque::push_back(const int &value) {
+    // Allocate outside of the critical section.
+    Node *newNode = NodeCache::local().take(value, nullptr, NIL);
+
+    Guard guard(*this, End::kBack);
+    Node *last = NIL->prev;
+    newNode->prev = last;
+    last->next = newNode;
+    NIL->prev = newNode;
+    size_.fetch_add(1);
+}
+
+void concurrent_deque::push_front(const int &value) {
+    Node *newNode = NodeCache::local().take(value, NIL, nullptr);
+
+    Guard guard(*this, End::kFront);
+    Node *first = NIL->next;
+    newNode->next = first;
+    first->prev = newNode;
+    NIL->next = newNode;
+    size_.fetch_add(1);
+}
+
+bool concurrent_deque::pop_back(int &value) {
+    Node *last;
+    {
+        Guard guard(*this, End::kBack);
+        last = NIL->prev;
+        if (last == NIL)
+            return false;
+        NIL->prev = last->prev;
+        last->prev->next = NIL;
+        size_.fetch_sub(1);
+    }
+    value = last->value;
+    NodeCache::local().put(last);
+    return true;
+}
+
+bool concurrent_deque::pop_front(int &value) {
+    Node *first;
+    {
+        Guard guard(*this, End::kFront);
+        first = NIL->next;
+        if (first == NIL)
+            return false;
+        NIL->next = first->next;
+        first->next->prev = NIL;
+        size_.fetch_sub(1);
+    }
+    value = first->value;
+    NodeCache::local().put(first);
+    return true;
+}
+
+bool concurrent_deque::empty() const {
+    return size_.load() == 0;
+}
+
+size_t concurrent_deque::size() const {
+    return size_.load();
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+
+namespace task {
+
+
+    // Multi-producer multi-consumer deque of ints with the same circular layout
+    // as task::list: a sentinel NIL whose next is the front and whose prev is the
+    // back. The two ends are guarded by separate locks, so front and back
+    // operations run in parallel while the deque holds at least kTwoLockMinSize
+    // elements. Closer to empty, one operation can touch the nodes of the other
+    // end, and it takes both locks instead. Nodes come from a per-thread cache
+    // outside of the locks, new/delete only run when a thread has none to spare.
+    class concurrent_deque {
+
+    public:
+
+        concurrent_deque();
+
+        concurrent_deque(const concurrent_deque &) = delete;
+
+        concurrent_deque &operator=(const concurrent_deque &) = delete;
+
+        ~concurrent_deque();
+
+
+        void push_back(const int &value);
+
+        void push_front(const int &value);
+
+        // Moves the element into `value` and returns true, or returns false if the
+        // deque was empty.
+        bool pop_back(int &value);
+
+        bool pop_front(int &value);
+
+
+        // Both are snapshots, other threads may change the deque right after.
+        bool empty() const;
+
+        size_t size() const;
+
+        // Two concurrent pops from opposite ends only stay on disjoint nodes when
+        // at least three elements are linked before either of them starts.
+        static const size_t kTwoLockMinSize = 3;
+
+    private:
+        struct Node {
+            int value;
+            Node *prev;
+            Node *next;
+        };
+
+        enum class End {
+            kFront,
+            kBack
+        };
+
+        // Locks `end` alone if the deque is long enough, both ends otherwise.
+        // Always locks head before tail.
+        class Guard;
+
+        // Free nodes of the calling thread, shared by all deques.
+        class NodeCache;
+
+        Node sentinel_{0, nullptr, nullptr};
+        Node *const NIL = &sentinel_;
+        std::mutex head_mutex_;
+        std::mutex tail_mutex_;
+        std::atomic<size_t> size_{0};
+    };
+}
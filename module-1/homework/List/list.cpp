@@ -1,10 +1,46 @@
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <utility>
 #include <vector>
 #include "list.h"
 
 // Your code goes here...
 using namespace task;
 
+const size_t list::kParallelSortMinSegment;
+const size_t list::kRadixBuckets;
+
+
+namespace {
+
+    // Runs jobs[1..] on threads of their own and jobs[0] on the calling thread.
+    // A job whose thread cannot be started runs inline instead.
+    void RunParallel(const std::vector<std::function<void()>> &jobs) {
+        std::vector<std::thread> workers;
+        workers.reserve(jobs.size());
+        for (size_t i = 1; i < jobs.size(); i++) {
+            try {
+                workers.emplace_back(jobs[i]);
+            } catch (const std::system_error &) {
+                jobs[i]();
+            }
+        }
+        if (!jobs.empty())
+            jobs[0]();
+        for (std::thread &worker : workers)
+            worker.join();
+    }
+
+    // Flipping the sign bit orders negative values before positive ones.
+    uint32_t RadixKey(int value) {
+        return static_cast<uint32_t>(value) ^ 0x80000000u;
+    }
+}
+
 
 list::list() {
     NIL->setPrev(NIL);
@@ -12,40 +48,61 @@ list::list() {
 }
 
 list::list(size_t count, const int &value) : list() {
-    for (size_t i = 0; i < count; i++)
-        push_back(value);
-    size_ = count;
+    assign(count, value);
 }
 
 list::list(const list &other) : list() {
-    Node *otherHead = other.NIL->getNext();
-    for (int i = 0; i < other.size(); i++) {
-        push_back(otherHead->getValue());
-        otherHead = otherHead->getNext();
-    }
+    pool().reserve(other.size_);
+    for (Node *tmp = other.NIL->getNext(); tmp != other.NIL; tmp = tmp->getNext())
+        push_back(tmp->getValue());
+}
+
+list::list(list &&other) noexcept : list() {
+    steal(other);
 }
 
 list::~list() {
-    Node *tmp = NIL->getNext();
-    while (tmp != NIL) {
-        tmp = tmp->getNext();
-        delete tmp->getPrev();
-    }
-    delete NIL;
+    clear();
 }
 
 list &list::operator=(const list &other) {
     if (this != &other) {
-        clear();
-        Node *tmp = other.NIL->getNext();
-        while (tmp != other.NIL) {
-            push_back(tmp->getValue());
-            tmp = tmp->getNext();
+        // Overwrite the nodes we already have, then trim or extend the tail.
+        Node *tmp = NIL->getNext();
+        Node *otherTmp = other.NIL->getNext();
+        for (; tmp != NIL && otherTmp != other.NIL; tmp = tmp->getNext()) {
+            tmp->getValueRefer() = otherTmp->getValue();
+            otherTmp = otherTmp->getNext();
         }
+        erase(const_iterator(tmp), end());
+        if (otherTmp != other.NIL)
+            pool().reserve(other.size_ - size_);
+        for (; otherTmp != other.NIL; otherTmp = otherTmp->getNext())
+            push_back(otherTmp->getValue());
     }
     return *this;
 }
 
+list &list::operator=(list &&other) noexcept {
+    if (this != &other) {
+        clear();
+        steal(other);
+    }
+    return *this;
+}
+
+void list::assign(size_t count, const int &value) {
+    Node *tmp = NIL->getNext();
+    size_t reused = 0;
+    for (; tmp != NIL && reused < count; tmp = tmp->getNext(), reused++)
+        tmp->getValueRefer() = value;
+    erase(const_iterator(tmp), end());
+    if (reused < count)
+        pool().reserve(count - reused);
+    for (; reused < count; reused++)
+        push_back(value);
+}
+
 int &list::front() {
     if (NIL->getNext() == NIL)
         throw std::logic_error("Cannot take front from empty list!");
@@ -70,6 +127,36 @@ const int &list::back() const {
     return NIL->getPrev()->getValueRefer();
 }
 
+int &list::at(size_t pos) {
+    if (pos >= size_)
+        throw std::out_of_range("List index out of range!");
+    return index().find(pos)->getValueRefer();
+}
+
+const int &list::at(size_t pos) const {
+    if (pos >= size_)
+        throw std::out_of_range("List index out of range!");
+    if (indexed())
+        return index_->find(pos)->getValueRefer();
+    return walk(pos)->getValueRefer();
+}
+
+list::iterator list::begin() {
+    return iterator(NIL->getNext());
+}
+
+list::const_iterator list::begin() const {
+    return const_iterator(NIL->getNext());
+}
+
+list::iterator list::end() {
+    return iterator(NIL);
+}
+
+list::const_iterator list::end() const {
+    return const_iterator(NIL);
+}
+
 bool list::empty() const {
     return size_ == 0;
 }
@@ -79,44 +166,70 @@ size_t list::size() const {
 }
 
 void list::clear() {
-    while (NIL->getNext() != NIL)
-        pop_back();
+    if (!pool_) {
+        // Never allocated a node, or the nodes were moved away.
+    } else if (pool_.use_count() == 1) {
+        // Nodes are trivially destructible, the pool frees their chunks wholesale.
+        pool_->release();
+    } else {
+        // Other lists still live in this pool, give the nodes back one by one.
+        Node *tmp = NIL->getNext();
+        while (tmp != NIL) {
+            Node *next = tmp->getNext();
+            pool_->destroy(tmp);
+            tmp = next;
+        }
+    }
+    NIL->setPrev(NIL);
+    NIL->setNext(NIL);
     size_ = 0;
+    dropIndex();
 }
 
 void list::push_back(const int &value) {
     Node *last = NIL->getPrev();
-    Node *newNode = new Node(value, NIL, last);
+    Node *newNode = pool().create(value, NIL, last);
 
     NIL->setPrev(newNode);
     last->setNext(newNode);
     size_++;
+    if (indexed())
+        index_->inserted(size_ - 1, newNode);
 }
 
 void list::pop_back() {
     Node *top = NIL->getPrev();
     if (top == NIL)
         throw std::logic_error("Cannot pop from empty list!");
+    if (indexed())
+        index_->erased(size_ - 1, NIL);
     remove(top);
 }
 
 void list::push_front(const int &value) {
     Node *first = NIL->getNext();
-    Node *newNode = new Node(value, first, NIL);
+    Node *newNode = pool().create(value, first, NIL);
 
     first->setPrev(newNode);
     NIL->setNext(newNode);
     size_++;
+    if (indexed())
+        index_->inserted(0, newNode);
 }
 
 void list::pop_front() {
     Node *top = NIL->getNext();
     if (top == NIL)
         throw std::logic_error("Cannot pop from empty list!");
+    if (indexed())
+        index_->erased(0, top->getNext());
     remove(top);
 }
 
 void list::resize(size_t count) {
+    dropIndex();
+    if (size_ < count)
+        pool().reserve(count - size_);
     while (size_ < count)  // if count > size
         push_back(0);
     while (size_ > count)  // if count < size
@@ -126,59 +239,252 @@ void list::resize(size_t count) {
 }
 
 void list::swap(list &other) {
-    Node *thisNext = NIL->getNext();
-    Node *thisPrev = NIL->getPrev();
+    if (this == &other)
+        return;
+    list tmp(std::move(other));
+    other.steal(*this);
+    steal(tmp);
+}
 
-    NIL->getNext()->setPrev(other.NIL);
-    NIL->setNext(other.NIL->getNext());
-    NIL->getPrev()->setNext(other.NIL);
-    NIL->setPrev(other.NIL->getPrev());
+list::iterator list::insert(const_iterator pos, const int &value) {
+    dropIndex();
+    return iterator(linkBefore(pos.node_, value));
+}
 
-    other.NIL->getNext()->setPrev(NIL);
-    other.NIL->setNext(thisNext);
-    other.NIL->getPrev()->setNext(NIL);
-    other.NIL->setPrev(thisPrev);
+list::iterator list::insert_at(size_t pos, const int &value) {
+    if (pos > size_)
+        throw std::out_of_range("Cannot insert past the end of list!");
+    PositionIndex<Node> &positions = index();
+    Node *newNode = linkBefore(pos == size_ ? NIL : positions.find(pos), value);
+    positions.inserted(pos, newNode);
+    return iterator(newNode);
+}
 
-    size_t tmp = size_;
-    size_ = other.size_;
-    other.size_ = tmp;
+list::iterator list::erase(const_iterator pos) {
+    dropIndex();
+    Node *next = pos.node_->getNext();
+    remove(pos.node_);
+    return iterator(next);
 }
 
-void list::remove(const int &value) {
-    Node *tmp = NIL->getNext();
-    while (tmp != NIL) {
-        tmp = tmp->getNext();
-        if (tmp->getPrev()->getValue() == value)
-            remove(tmp->getPrev());
-    }
+list::iterator list::erase(const_iterator first, const_iterator last) {
+    while (first != last)
+        first = erase(first);
+    return iterator(last.node_);
 }
 
-void list::unique() {
-    Node *tmp = NIL->getNext()->getNext();
+void list::splice(const_iterator pos, list &other) {
+    if (&other == this || other.empty())
+        return;
+    splice(pos, other, other.begin(), other.end());
+}
 
-    while (tmp->getPrev() != NIL) {
-        Node *prev = tmp->getPrev();
-        if (prev->getValue() == tmp->getValue())
-            remove(prev);
-        tmp = tmp->getNext();
+void list::splice(const_iterator pos, list &other, const_iterator it) {
+    const_iterator next = it;
+    splice(pos, other, it, ++next);
+}
+
+void list::splice(const_iterator pos, list &other, const_iterator first, const_iterator last) {
+    if (first == last)
+        return;
+
+    dropIndex();
+    other.dropIndex();
+    if (!adoptPool(other)) {
+        // Both pools are shared with third lists, fall back to copying.
+        while (first != last) {
+            insert(pos, *first);
+            first = other.erase(first);
+        }
+        return;
+    }
+
+    Node *head = first.node_;
+    Node *tail = last.node_->getPrev();
+    if (&other != this) {
+        size_t count = (first == other.begin() && last == other.end()) ? other.size_ : 0;
+        if (count == 0) {
+            for (const_iterator it = first; it != last; ++it)
+                count++;
+        }
+        other.size_ -= count;
+        size_ += count;
+    }
+    unlink(head, tail);
+    link(pos.node_, head, tail);
+}
+
+void list::merge(list &other) {
+    if (&other == this || other.empty())
+        return;
+    dropIndex();
+    other.dropIndex();
+    if (!adoptPool(other)) {
+        list copy(other);
+        other.clear();
+        merge(copy);
+        return;
     }
+
+    NIL->getPrev()->setNext(nullptr);
+    other.NIL->getPrev()->setNext(nullptr);
+    Node *head = mergeChains(empty() ? nullptr : NIL->getNext(), other.NIL->getNext());
+
+    size_ += other.size_;
+    other.size_ = 0;
+    other.NIL->setNext(other.NIL);
+    other.NIL->setPrev(other.NIL);
+    relink(head);
+}
+
+void list::remove(const int &value_ref) {
+    // value_ref may refer into a node that is about to be removed
+    const int value = value_ref;
+    remove_if([value](int element) { return element == value; });
+}
+
+void list::unique() {
+    unique([](int first, int second) { return first == second; });
 }
 
 void list::sort() {
     if (size_ < 2)
         return;
-    list left = list();
-    list right = list(*this);
+    NIL->getPrev()->setNext(nullptr);
+    relink(sortChain(NIL->getNext()));
+}
+
+void list::radix_sort() {
+    if (size_ < 2)
+        return;
+
+    // A pass over a byte that is equal in every key would leave the order as is.
+    uint32_t previous = RadixKey(NIL->getNext()->getValue());
+    uint32_t first = previous;
+    uint32_t differing = 0;
+    bool sorted = true;
+    for (Node *tmp = NIL->getNext()->getNext(); tmp != NIL; tmp = tmp->getNext()) {
+        uint32_t key = RadixKey(tmp->getValue());
+        differing |= key ^ first;
+        sorted = sorted && previous <= key;
+        previous = key;
+    }
+    if (sorted)
+        return;
+
+    // The most significant differing byte goes first: it splits the list into up
+    // to 256 independent buckets that are small enough to stay in cache while
+    // their lower bytes are sorted least significant first. A plain LSD pass order
+    // would instead chase the whole list through memory four times.
+    const size_t kSmallBucket = 64;
+    unsigned topShift = 24;
+    while (((differing >> topShift) & 0xFF) == 0)
+        topShift -= 8;
+    Chain top[kRadixBuckets];
+    Chain low[kRadixBuckets];
+
+    NIL->getPrev()->setNext(nullptr);
+    distribute(NIL->getNext(), topShift, top);
+
+    for (Chain &bucket : top) {
+        if (bucket.size < 2)
+            continue;
+        if (bucket.size < kSmallBucket) {
+            bucket.head = sortChain(bucket.head);
+            for (bucket.tail = bucket.head; bucket.tail->getNext() != nullptr;)
+                bucket.tail = bucket.tail->getNext();
+            continue;
+        }
+        for (unsigned shift = 0; shift < topShift; shift += 8) {
+            if (((differing >> shift) & 0xFF) == 0)
+                continue;
+            distribute(bucket.head, shift, low);
+            bucket = concatenate(low);
+        }
+    }
+
+    relink(concatenate(top).head);
+}
+
+void list::parallel_sort(size_t threads) {
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, size_ / kParallelSortMinSegment);
+    if (threads < 2) {
+        sort();
+        return;
+    }
+
+    // Cut the chain into nullptr-terminated segments of near equal length.
+    std::vector<Node *> segments(threads);
+    NIL->getPrev()->setNext(nullptr);
     Node *tmp = NIL->getNext();
-    for (size_t i = 0; i < size_ / 2; i++) {
-        left.push_back(tmp->getValue());
-        tmp = tmp->getNext();
-        right.pop_front();
+    for (size_t i = 0; i < threads; i++) {
+        segments[i] = tmp;
+        size_t length = size_ / threads + (i < size_ % threads ? 1 : 0);
+        for (size_t j = 1; j < length; j++)
+            tmp = tmp->getNext();
+        Node *next = tmp->getNext();
+        tmp->setNext(nullptr);
+        tmp = next;
+    }
+
+    std::vector<std::function<void()>> jobs;
+    for (Node *&segment : segments)
+        jobs.emplace_back([&segment] { segment = sortChain(segment); });
+    RunParallel(jobs);
+
+    // Neighbouring segments are merged pairwise, earlier one first, to stay stable.
+    for (size_t step = 1; step < threads; step *= 2) {
+        jobs.clear();
+        for (size_t i = 0; i + step < threads; i += 2 * step) {
+            Node *&left = segments[i];
+            Node *&right = segments[i + step];
+            jobs.emplace_back([&left, &right] { left = mergeChains(left, right); });
+        }
+        RunParallel(jobs);
+    }
+
+    relink(segments[0]);
+}
+
+size_t list::memory_usage() const {
+    return pool_ ? pool_->bytes() : 0;
+}
+
+void list::distribute(Node *head, unsigned shift, Chain *buckets) {
+    std::fill(buckets, buckets + kRadixBuckets, Chain());
+    for (Node *tmp = head; tmp != nullptr; tmp = tmp->getNext()) {
+        Chain &bucket = buckets[(RadixKey(tmp->getValue()) >> shift) & 0xFF];
+        if (bucket.head == nullptr)
+            bucket.head = tmp;
+        else
+            bucket.tail->setNext(tmp);
+        bucket.tail = tmp;
+        bucket.size++;
+    }
+    for (size_t i = 0; i < kRadixBuckets; i++) {
+        if (buckets[i].tail != nullptr)
+            buckets[i].tail->setNext(nullptr);
+    }
+}
+
+list::Chain list::concatenate(const Chain *buckets) {
+    Chain result;
+    for (size_t i = 0; i < kRadixBuckets; i++) {
+        const Chain &bucket = buckets[i];
+        if (bucket.head == nullptr)
+            continue;
+        if (result.head == nullptr)
+            result.head = bucket.head;
+        else
+            result.tail->setNext(bucket.head);
+        result.tail = bucket.tail;
+        result.size += bucket.size;
     }
-    left.sort();
-    right.sort();
-    list res = merge(left, right);
-    *this = res;
+    if (result.tail != nullptr)
+        result.tail->setNext(nullptr);
+    return result;
 }
 
 void list::remove(list::Node *node) {
@@ -186,28 +492,166 @@ void list::remove(list::Node *node) {
     Node *next = node->getNext();
     prev->setNext(next);
     next->setPrev(prev);
-    delete node;
+    pool_->destroy(node);
     size_--;
 }
 
-list &list::merge(list &first, list &second) {
-    list *result = new list();
-    Node *fHead = first.NIL->getNext();
-    Node *sHead = second.NIL->getNext();
-    while (fHead != first.NIL || sHead != second.NIL) {
-        if (sHead == second.NIL) {
-            result->push_back(fHead->getValue());
-            fHead = fHead->getNext();
-        } else if (fHead == first.NIL) {
-            result->push_back(sHead->getValue());
-            sHead = sHead->getNext();
-        } else if (sHead->getValue() > fHead->getValue()) {
-            result->push_back(fHead->getValue());
-            fHead = fHead->getNext();
+void list::finishFilter(Node *kept, Node *rest, NodePool<Node>::Batch &removed, size_t count) {
+    closeGap(kept, rest);
+    size_ -= count;
+    if (count != 0)
+        pool_->destroy(removed);
+}
+
+void list::link(Node *pos, Node *first, Node *last) {
+    Node *prev = pos->getPrev();
+    prev->setNext(first);
+    first->setPrev(prev);
+    last->setNext(pos);
+    pos->setPrev(last);
+}
+
+void list::unlink(Node *first, Node *last) {
+    first->getPrev()->setNext(last->getNext());
+    last->getNext()->setPrev(first->getPrev());
+}
+
+bool list::adoptPool(list &other) {
+    if (pool_ == other.pool_ || !other.pool_)
+        return true;
+    if (!pool_) {
+        pool_ = other.pool_;
+        return true;
+    }
+    if (other.pool_.use_count() == 1) {
+        pool_->absorb(*other.pool_);
+        other.pool_ = pool_;
+        return true;
+    }
+    if (pool_.use_count() == 1) {
+        other.pool_->absorb(*pool_);
+        pool_ = other.pool_;
+        return true;
+    }
+    return false;
+}
+
+list::Node *list::sortChain(Node *head) {
+    // bins[i] holds a sorted run of 2^i nodes (or nothing), as in libstdc++.
+    const size_t kBins = 64;
+    Node *bins[kBins] = {};
+    size_t used = 0;
+
+    while (head != nullptr) {
+        Node *carry = head;
+        head = head->getNext();
+        carry->setNext(nullptr);
+
+        size_t i = 0;
+        for (; i < used && bins[i] != nullptr; i++) {
+            carry = mergeChains(bins[i], carry);
+            bins[i] = nullptr;
+        }
+        if (i == used)
+            used++;
+        bins[i] = carry;
+    }
+
+    Node *result = nullptr;
+    for (size_t i = 0; i < used; i++) {
+        if (bins[i] != nullptr)
+            result = result == nullptr ? bins[i] : mergeChains(bins[i], result);
+    }
+    return result;
+}
+
+list::Node *list::mergeChains(Node *first, Node *second) {
+    // Ties are taken from `first`, which holds the earlier elements.
+    Node head(0);
+    Node *tail = &head;
+    while (first != nullptr && second != nullptr) {
+        if (second->getValue() < first->getValue()) {
+            tail->setNext(second);
+            second = second->getNext();
         } else {
-            result->push_back(sHead->getValue());
-            sHead = sHead->getNext();
+            tail->setNext(first);
+            first = first->getNext();
         }
+        tail = tail->getNext();
+    }
+    tail->setNext(first != nullptr ? first : second);
+    return head.getNext();
+}
+
+NodePool<list::Node> &list::pool() {
+    if (!pool_)
+        pool_ = std::make_shared<NodePool<Node>>();
+    return *pool_;
+}
+
+PositionIndex<list::Node> &list::index() {
+    if (!index_)
+        index_.reset(new PositionIndex<Node>());
+    if (!index_->valid())
+        index_->rebuild(NIL->getNext(), size_);
+    return *index_;
+}
+
+list::Node *list::walk(size_t pos) const {
+    Node *tmp;
+    if (pos < size_ / 2) {
+        for (tmp = NIL->getNext(); pos > 0; pos--)
+            tmp = tmp->getNext();
+    } else {
+        for (tmp = NIL->getPrev(); pos < size_ - 1; pos++)
+            tmp = tmp->getPrev();
+    }
+    return tmp;
+}
+
+bool list::indexed() const {
+    return index_ && index_->valid();
+}
+
+void list::dropIndex() {
+    if (indexed())
+        index_->invalidate();
+}
+
+list::Node *list::linkBefore(Node *pos, const int &value) {
+    Node *newNode = pool().create(value, pos, pos->getPrev());
+
+    pos->getPrev()->setNext(newNode);
+    pos->setPrev(newNode);
+    size_++;
+    return newNode;
+}
+
+void list::steal(list &other) noexcept {
+    if (other.size_ != 0) {
+        Node *first = other.NIL->getNext();
+        Node *last = other.NIL->getPrev();
+        NIL->setNext(first);
+        first->setPrev(NIL);
+        NIL->setPrev(last);
+        last->setNext(NIL);
+        other.NIL->setNext(other.NIL);
+        other.NIL->setPrev(other.NIL);
+    }
+    size_ = other.size_;
+    other.size_ = 0;
+    pool_ = std::move(other.pool_);
+    index_ = std::move(other.index_);
+}
+
+void list::relink(Node *head) {
+    dropIndex();
+    Node *prev = NIL;
+    for (Node *tmp = head; tmp != nullptr; tmp = tmp->getNext()) {
+        tmp->setPrev(prev);
+        prev->setNext(tmp);
+        prev = tmp;
     }
-    return *result;
+    prev->setNext(NIL);
+    NIL->setPrev(prev);
 }
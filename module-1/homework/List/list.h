@@ -1,6 +1,11 @@
 #pragma once
 
 #include <cstddef>
+#include <iterator>
+#include <memory>
+
+#include "node_pool.h"
+#include "position_index.h"
 
 
 namespace task {
@@ -8,7 +13,79 @@ namespace task {
 
     class list {
 
+    private:
+        class Node;
+
     public:
+        template <class Value>
+        class basic_iterator {
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = int;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Value *;
+            using reference = Value &;
+
+            basic_iterator() = default;
+
+            explicit basic_iterator(Node *node) : node_(node) {
+            }
+
+            // iterator -> const_iterator
+            template <class OtherValue>
+            basic_iterator(const basic_iterator<OtherValue> &other) : node_(other.node_) {
+            }
+
+            reference operator*() const {
+                return node_->getValueRefer();
+            }
+
+            pointer operator->() const {
+                return &node_->getValueRefer();
+            }
+
+            basic_iterator &operator++() {
+                node_ = node_->getNext();
+                return *this;
+            }
+
+            basic_iterator operator++(int) {
+                basic_iterator copy(*this);
+                ++*this;
+                return copy;
+            }
+
+            basic_iterator &operator--() {
+                node_ = node_->getPrev();
+                return *this;
+            }
+
+            basic_iterator operator--(int) {
+                basic_iterator copy(*this);
+                --*this;
+                return copy;
+            }
+
+            bool operator==(const basic_iterator &other) const {
+                return node_ == other.node_;
+            }
+
+            bool operator!=(const basic_iterator &other) const {
+                return node_ != other.node_;
+            }
+
+        private:
+            friend class list;
+
+            template <class>
+            friend class basic_iterator;
+
+            Node *node_ = nullptr;
+        };
+
+        using iterator = basic_iterator<int>;
+        using const_iterator = basic_iterator<const int>;
+
 
         list();
 
@@ -16,10 +93,19 @@ namespace task {
 
         list(const list &other);
 
+        // Takes over the nodes and the pool of `other` in O(1), leaving it empty.
+        list(list &&other) noexcept;
+
         ~list();
 
+        // Reuses the nodes this list already has before allocating new ones.
         list &operator=(const list &other);
 
+        list &operator=(list &&other) noexcept;
+
+        // Reuses existing nodes; the missing ones are allocated as one chunk.
+        void assign(size_t count, const int &value);
+
 
         int &front();
 
@@ -29,6 +115,29 @@ namespace task {
 
         const int &back() const;
 
+        // Positional access in O(log n) through a skip list over every
+        // PositionIndex::kSegment-th node. The index is built on the first call;
+        // push/pop at either end and insert_at() keep it up to date, every other
+        // modifying operation drops it and the next positional call rebuilds it in
+        // O(n). Throws std::out_of_range for pos >= size().
+        int &at(size_t pos);
+
+        // Uses the index if it is up to date and walks from the nearer end
+        // otherwise. It never builds the index, so concurrent const calls are safe.
+        const int &at(size_t pos) const;
+
+        // Inserts before the element at `pos`, or at the end if pos == size().
+        iterator insert_at(size_t pos, const int &value);
+
+
+        iterator begin();
+
+        const_iterator begin() const;
+
+        iterator end();
+
+        const_iterator end() const;
+
 
         bool empty() const;
 
@@ -49,14 +158,59 @@ namespace task {
 
         void swap(list &other);
 
+        iterator insert(const_iterator pos, const int &value);
+
+        iterator erase(const_iterator pos);
+
+        iterator erase(const_iterator first, const_iterator last);
+
+
+        // Splicing relinks nodes, nothing is copied or reallocated. Lists that
+        // exchange nodes end up sharing one node pool, see adoptPool().
+        void splice(const_iterator pos, list &other);
+
+        void splice(const_iterator pos, list &other, const_iterator it);
+
+        void splice(const_iterator pos, list &other, const_iterator first, const_iterator last);
+
+        // Merges the sorted `other` into this sorted list in linear time, leaving `other` empty.
+        void merge(list &other);
+
 
         void remove(const int &value);
 
         void unique();
 
+        // Single pass: matching nodes are retired into a batch that goes back to
+        // the node pool in one step once the pass is over. Only the nodes on
+        // either side of a run of removed ones are relinked.
+        template <class Predicate>
+        void remove_if(Predicate pred);
+
+        // Keeps the first element of every run of elements for which
+        // pred(first, element) holds.
+        template <class BinaryPredicate>
+        void unique(BinaryPredicate pred);
+
         void sort();
 
-        // Your code goes here?..
+        // Radix sort over the four bytes of the value, relinking the nodes into 256
+        // bucket chains per byte. A first scan returns early if the list is
+        // already sorted and skips the bytes that all elements share. Stable,
+        // allocation free, O(n).
+        void radix_sort();
+
+        // Splits the node chain into one segment per thread, sorts the segments
+        // concurrently and merges them pairwise, again in parallel. threads == 0
+        // means std::thread::hardware_concurrency(). Short lists are sorted in
+        // place by sort(). Stable, relinks nodes only.
+        void parallel_sort(size_t threads = 0);
+
+        // Segments shorter than this are not worth a thread of their own.
+        static const size_t kParallelSortMinSegment = 1 << 14;
+
+        // Bytes held by the node pool, which lists that exchanged nodes share.
+        size_t memory_usage() const;
 
     private:
         class Node {
@@ -91,22 +245,143 @@ namespace task {
                 prev = newPrev;
             }
 
-            ~Node() {
-                next = nullptr;
-                prev = nullptr;
-            }
-
         private:
             int value;
             Node *prev;
             Node *next;
         };
 
-        Node *NIL = new Node(0);
+        // The sentinel lives inside the list, so moves and swaps only relink the
+        // first and last nodes and never allocate.
+        Node sentinel_{0};
+        Node *const NIL = &sentinel_;
         size_t size_ = 0;
+        // Created with the first node; empty lists and moved-from lists have none.
+        std::shared_ptr<NodePool<Node>> pool_;
+        // Created by the first non-const positional call, moves with the nodes.
+        std::unique_ptr<PositionIndex<Node>> index_;
+
+        NodePool<Node> &pool();
+
+        // The positional index, built or rebuilt if needed.
+        PositionIndex<Node> &index();
+
+        // The node at pos < size_, walked to from the nearer end in O(n).
+        Node *walk(size_t pos) const;
+
+        bool indexed() const;
+
+        // Called by every operation that relinks nodes without telling the index.
+        void dropIndex();
+
+        Node *linkBefore(Node *pos, const int &value);
+
+        // Moves the nodes and the pool of `other` into this empty list.
+        void steal(list &other) noexcept;
 
         void remove(Node *);
 
-        static list &merge(list &, list &);
+        // Ends a remove_if/unique pass: links `rest` (the sentinel or the node the
+        // predicate threw on) after the last kept node and frees the `count`
+        // nodes retired into `removed`.
+        void finishFilter(Node *kept, Node *rest, NodePool<Node>::Batch &removed, size_t count);
+
+        // Links the kept node `next` after `kept` unless they are still adjacent,
+        // so filters write nothing into runs of nodes they keep.
+        static void closeGap(Node *kept, Node *next) {
+            if (kept->getNext() != next) {
+                kept->setNext(next);
+                next->setPrev(kept);
+            }
+        }
+
+        // Links the detached chain [first, last] in front of pos.
+        static void link(Node *pos, Node *first, Node *last);
+
+        static void unlink(Node *first, Node *last);
+
+        // Makes the nodes of `other` freeable through this list's pool. O(1) if the
+        // pools are already shared, O(chunks) if one of them can be merged into the
+        // other; false if both pools are shared with third lists.
+        bool adoptPool(list &other);
+
+        // Stable bottom-up merge sort over a nullptr-terminated chain linked by next.
+        static Node *sortChain(Node *head);
+
+        static Node *mergeChains(Node *first, Node *second);
+
+        static const size_t kRadixBuckets = 256;
+
+        struct Chain {
+            Node *head = nullptr;
+            Node *tail = nullptr;
+            size_t size = 0;
+        };
+
+        // Splits a nullptr-terminated chain into 256 chains by one byte of the
+        // sign-flipped value, keeping the relative order inside every bucket.
+        static void distribute(Node *head, unsigned shift, Chain *buckets);
+
+        static Chain concatenate(const Chain *buckets);
+
+        // Links a nullptr-terminated chain between the sentinel's ends and repairs prev.
+        void relink(Node *head);
     };
+
+
+    template <class Predicate>
+    void list::remove_if(Predicate pred) {
+        dropIndex();
+        NodePool<Node>::Batch removed;
+        Node *kept = NIL;
+        size_t count = 0;
+
+        Node *tmp = NIL->getNext();
+        try {
+            while (tmp != NIL) {
+                Node *next = tmp->getNext();
+                if (pred(tmp->getValue())) {
+                    pool_->retire(tmp, removed);
+                    count++;
+                } else {
+                    closeGap(kept, tmp);
+                    kept = tmp;
+                }
+                tmp = next;
+            }
+        } catch (...) {
+            finishFilter(kept, tmp, removed, count);
+            throw;
+        }
+        finishFilter(kept, NIL, removed, count);
+    }
+
+    template <class BinaryPredicate>
+    void list::unique(BinaryPredicate pred) {
+        if (size_ < 2)
+            return;
+        dropIndex();
+        NodePool<Node>::Batch removed;
+        Node *kept = NIL->getNext();
+        size_t count = 0;
+
+        Node *tmp = kept->getNext();
+        try {
+            while (tmp != NIL) {
+                Node *next = tmp->getNext();
+                if (pred(kept->getValue(), tmp->getValue())) {
+                    pool_->retire(tmp, removed);
+                    count++;
+                } else {
+                    closeGap(kept, tmp);
+                    kept = tmp;
+                }
+                tmp = next;
+            }
+        } catch (...) {
+            finishFilter(kept, tmp, removed, count);
+            throw;
+        }
+        finishFilter(kept, NIL, removed, count);
+    }
 }
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace task {
+
+
+    // Slab pool for fixed-size objects (list nodes).
+    //
+    // Objects are carved out of contiguous chunks whose size grows geometrically
+    // up to `max_chunk` slots. Destroyed objects go to an intrusive free list and
+    // are handed out again before the pool touches a fresh slot, so churn never
+    // reaches the system allocator. release() gives every chunk back at once; it
+    // does not run destructors, so it is only meant for trivially destructible T
+    // or for objects that have already been destroyed.
+    template <typename T>
+    class NodePool {
+
+    public:
+
+        explicit NodePool(size_t first_chunk = 16, size_t max_chunk = 4096)
+            : next_chunk_(std::max<size_t>(first_chunk, 1)),
+              first_chunk_(next_chunk_),
+              max_chunk_(std::max(max_chunk, next_chunk_)) {
+        }
+
+        NodePool(const NodePool &) = delete;
+
+        NodePool &operator=(const NodePool &) = delete;
+
+        ~NodePool() {
+            release();
+        }
+
+
+        template <typename... Args>
+        T *create(Args &&... args) {
+            Slot *slot = take();
+            try {
+                return ::new(static_cast<void *>(slot)) T(std::forward<Args>(args)...);
+            } catch (...) {
+                put(slot);
+                throw;
+            }
+        }
+
+        void destroy(T *object) {
+            object->~T();
+            put(reinterpret_cast<Slot *>(object));
+        }
+
+        // Objects destroyed by retire() that have not reached the free list yet.
+        class Batch;
+
+        // Destroys `object` into `batch` instead of the free list. A pass that
+        // drops many objects writes each one while it is still in cache and hands
+        // all of them to the free list with one destroy(batch) at the end.
+        void retire(T *object, Batch &batch) {
+            object->~T();
+            Slot *slot = reinterpret_cast<Slot *>(object);
+            slot->next = batch.head_;
+            if (batch.head_ == nullptr)
+                batch.tail_ = slot;
+            batch.head_ = slot;
+        }
+
+        void destroy(Batch &batch) {
+            if (batch.head_ == nullptr)
+                return;
+            batch.tail_->next = free_;
+            if (free_ == nullptr)
+                free_tail_ = batch.tail_;
+            free_ = batch.head_;
+            batch.head_ = batch.tail_ = nullptr;
+        }
+
+        void release() {
+            while (chunks_ != nullptr) {
+                Chunk *next = chunks_->next;
+                ::operator delete(chunks_);
+                chunks_ = next;
+            }
+            free_ = nullptr;
+            cursor_ = end_ = nullptr;
+            capacity_ = 0;
+            next_chunk_ = first_chunk_;
+        }
+
+        // Makes sure the next `count` objects cost at most this one chunk
+        // allocation. A fresh pool then hands them out contiguously; the untouched
+        // rest of the current chunk goes to the free list.
+        void reserve(size_t count) {
+            if (static_cast<size_t>(end_ - cursor_) >= count)
+                return;
+            while (cursor_ != end_)
+                put(cursor_++);
+            grow(count);
+        }
+
+        // Takes over every chunk of `other` and leaves it empty. Objects living in
+        // those chunks stay where they are and from now on belong to this pool.
+        // Costs O(chunks of other), independent of the number of objects.
+        void absorb(NodePool &other) {
+            if (&other == this || other.chunks_ == nullptr)
+                return;
+
+            Chunk *tail = other.chunks_;
+            while (tail->next != nullptr)
+                tail = tail->next;
+            tail->next = chunks_;
+            chunks_ = other.chunks_;
+            capacity_ += other.capacity_;
+
+            if (other.free_ != nullptr) {
+                other.free_tail_->next = free_;
+                if (free_ == nullptr)
+                    free_tail_ = other.free_tail_;
+                free_ = other.free_;
+            }
+
+            // Keep bumping through the larger untouched region, recycle the other one.
+            if (other.end_ - other.cursor_ > end_ - cursor_) {
+                std::swap(cursor_, other.cursor_);
+                std::swap(end_, other.end_);
+            }
+            while (other.cursor_ != other.end_)
+                put(other.cursor_++);
+            next_chunk_ = std::max(next_chunk_, other.next_chunk_);
+
+            other.chunks_ = nullptr;
+            other.free_ = nullptr;
+            other.cursor_ = other.end_ = nullptr;
+            other.capacity_ = 0;
+            other.next_chunk_ = other.first_chunk_;
+        }
+
+        void swap(NodePool &other) {
+            std::swap(free_, other.free_);
+            std::swap(free_tail_, other.free_tail_);
+            std::swap(chunks_, other.chunks_);
+            std::swap(cursor_, other.cursor_);
+            std::swap(end_, other.end_);
+            std::swap(capacity_, other.capacity_);
+            std::swap(next_chunk_, other.next_chunk_);
+            std::swap(first_chunk_, other.first_chunk_);
+            std::swap(max_chunk_, other.max_chunk_);
+        }
+
+        // Number of slots in all chunks, whether in use or not.
+        size_t capacity() const {
+            return capacity_;
+        }
+
+        // Bytes obtained from the system allocator, chunk headers included.
+        size_t bytes() const {
+            return capacity_ * sizeof(Slot) + chunk_count() * sizeof(Chunk);
+        }
+
+        size_t chunk_count() const {
+            size_t count = 0;
+            for (Chunk *chunk = chunks_; chunk != nullptr; chunk = chunk->next)
+                count++;
+            return count;
+        }
+
+    private:
+        union Slot {
+            Slot *next;
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+        };
+
+        struct alignas(Slot) Chunk {
+            Chunk *next;
+            size_t capacity;
+
+            Slot *begin() {
+                return reinterpret_cast<Slot *>(this + 1);
+            }
+        };
+
+        Slot *take() {
+            if (free_ != nullptr) {
+                Slot *slot = free_;
+                free_ = slot->next;
+                return slot;
+            }
+            if (cursor_ == end_)
+                grow(next_chunk_);
+            return cursor_++;
+        }
+
+        void put(Slot *slot) {
+            slot->next = free_;
+            if (free_ == nullptr)
+                free_tail_ = slot;
+            free_ = slot;
+        }
+
+        void grow(size_t count) {
+            void *memory = ::operator new(sizeof(Chunk) + count * sizeof(Slot));
+            Chunk *chunk = ::new(memory) Chunk{chunks_, count};
+            chunks_ = chunk;
+            cursor_ = chunk->begin();
+            end_ = cursor_ + count;
+            capacity_ += count;
+            next_chunk_ = std::min(next_chunk_ * 2, max_chunk_);
+        }
+
+        Slot *free_ = nullptr;
+        Slot *free_tail_ = nullptr;  // valid while free_ != nullptr
+        Chunk *chunks_ = nullptr;
+        Slot *cursor_ = nullptr;
+        Slot *end_ = nullptr;
+        size_t capacity_ = 0;
+        size_t next_chunk_;
+        size_t first_chunk_;
+        size_t max_chunk_;
+    };
+
+
+    template <typename T>
+    class NodePool<T>::Batch {
+    private:
+        friend class NodePool;
+
+        Slot *head_ = nullptr;
+        Slot *tail_ = nullptr;
+    };
+}
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <random>
+#include <vector>
+
+
+namespace task {
+
+
+    // Indexable skip list over every few nodes of a linked list, for O(log n)
+    // positional lookup without touching the nodes themselves.
+    //
+    // The list is cut into segments of consecutive nodes. Every segment has an
+    // anchor that points to its first node, and the anchors form a skip list
+    // whose links count the list elements they jump over. A lookup descends the
+    // skip list to the anchor of the right segment and walks the rest, at most
+    // 2 * kSegment nodes. Inserting or erasing a single element costs O(log n)
+    // as well; long segments are split, empty ones dropped.
+    //
+    // The index only sees what it is told. Whoever links or unlinks nodes behind
+    // its back must invalidate() it and rebuild() it before the next lookup.
+    // Node only needs getNext().
+    template <typename Node>
+    class PositionIndex {
+
+    public:
+
+        PositionIndex() : head_{nullptr, std::vector<Link>(kMaxLevel)} {
+        }
+
+        PositionIndex(const PositionIndex &) = delete;
+
+        PositionIndex &operator=(const PositionIndex &) = delete;
+
+        ~PositionIndex() {
+            invalidate();
+        }
+
+
+        bool valid() const {
+            return valid_;
+        }
+
+        // Forgets every anchor; lookups need a rebuild() afterwards.
+        void invalidate() {
+            Anchor *anchor = head_.links[0].next;
+            while (anchor != nullptr) {
+                Anchor *next = anchor->links[0].next;
+                delete anchor;
+                anchor = next;
+            }
+            for (Link &link : head_.links)
+                link = Link();
+            size_ = 0;
+            valid_ = false;
+        }
+
+        // Indexes the `size` nodes starting at `first`, in O(size).
+        void rebuild(Node *first, size_t size) {
+            invalidate();
+            Anchor *update[kMaxLevel];
+            size_t starts[kMaxLevel];
+            for (size_t i = 0; i < kMaxLevel; i++) {
+                head_.links[i].width = size;
+                update[i] = &head_;
+                starts[i] = 0;
+            }
+            size_ = size;
+
+            try {
+                Node *node = first;
+                for (size_t start = 0; start < size; start += kSegment) {
+                    Anchor *anchor = createAnchor(node);
+                    linkAnchor(anchor, start, update, starts);
+                    for (size_t i = 0; i < anchor->links.size(); i++) {
+                        update[i] = anchor;
+                        starts[i] = start;
+                    }
+                    if (start + kSegment < size) {
+                        for (size_t step = 0; step < kSegment; step++)
+                            node = node->getNext();
+                    }
+                }
+            } catch (...) {
+                invalidate();
+                throw;
+            }
+            valid_ = true;
+        }
+
+        // The node at `position`, which must be less than the indexed size.
+        Node *find(size_t position) const {
+            Anchor *update[kMaxLevel];
+            size_t starts[kMaxLevel];
+            Anchor *anchor = search(position, false, update, starts);
+            Node *node = anchor->node;
+            for (size_t step = starts[0]; step < position; step++)
+                node = node->getNext();
+            return node;
+        }
+
+        // Records that `node` has been linked at `position`; whatever was there
+        // before now follows it.
+        void inserted(size_t position, Node *node) {
+            Anchor *update[kMaxLevel];
+            size_t starts[kMaxLevel];
+
+            if (size_ == 0) {
+                Anchor *anchor = createAnchorOrInvalidate(node);
+                if (anchor == nullptr)
+                    return;
+                for (size_t i = 0; i < kMaxLevel; i++) {
+                    head_.links[i].width = 1;
+                    update[i] = &head_;
+                    starts[i] = 0;
+                }
+                linkAnchor(anchor, 0, update, starts);
+                size_ = 1;
+                return;
+            }
+
+            // An element appended at the end joins the last segment.
+            bool append = position == size_;
+            Anchor *anchor = search(append ? position - 1 : position, false, update, starts);
+            for (size_t i = 0; i < kMaxLevel; i++)
+                update[i]->links[i].width++;
+            if (!append && starts[0] == position)
+                anchor->node = node;
+            size_++;
+
+            if (anchor->links[0].width > 2 * kSegment)
+                split(anchor, update, starts);
+        }
+
+        // Records that the node at `position` has been unlinked; `next` is the
+        // node that followed it.
+        void erased(size_t position, Node *next) {
+            Anchor *update[kMaxLevel];
+            size_t starts[kMaxLevel];
+            Anchor *anchor = search(position, false, update, starts);
+            for (size_t i = 0; i < kMaxLevel; i++)
+                update[i]->links[i].width--;
+            size_--;
+
+            if (anchor->links[0].width != 0) {
+                if (starts[0] == position)
+                    anchor->node = next;
+                return;
+            }
+
+            // The segment is empty, unlink its anchor from strict predecessors.
+            search(position, true, update, starts);
+            for (size_t i = 0; i < anchor->links.size(); i++) {
+                update[i]->links[i].width += anchor->links[i].width;
+                update[i]->links[i].next = anchor->links[i].next;
+            }
+            delete anchor;
+        }
+
+        // Target segment length; segments are split once they double.
+        static const size_t kSegment = 32;
+
+    private:
+        struct Anchor;
+
+        struct Link {
+            Anchor *next = nullptr;
+            // Elements from the start of this segment up to the start of `next`,
+            // or up to the end of the list if there is no next.
+            size_t width = 0;
+        };
+
+        struct Anchor {
+            Node *node;
+            std::vector<Link> links;
+        };
+
+        static const size_t kMaxLevel = 32;
+
+        // Descends to the last anchor starting at or before `position` (strictly
+        // before if `strict`), recording the last anchor visited on every level
+        // and where its segment starts.
+        Anchor *search(size_t position, bool strict, Anchor **update, size_t *starts) const {
+            Anchor *anchor = const_cast<Anchor *>(&head_);
+            size_t start = 0;
+            for (size_t level = kMaxLevel; level-- > 0;) {
+                for (;;) {
+                    const Link &link = anchor->links[level];
+                    if (link.next == nullptr)
+                        break;
+                    size_t next_start = start + link.width;
+                    if (strict ? next_start >= position : next_start > position)
+                        break;
+                    start = next_start;
+                    anchor = link.next;
+                }
+                update[level] = anchor;
+                starts[level] = start;
+            }
+            return anchor;
+        }
+
+        // Inserts `anchor`, whose segment starts at `start`, after update[i] on
+        // every level it has. update[i]->links[i].width must already count the
+        // elements of the new segment.
+        static void linkAnchor(Anchor *anchor, size_t start, Anchor **update, const size_t *starts) {
+            for (size_t i = 0; i < anchor->links.size(); i++) {
+                Link &link = update[i]->links[i];
+                anchor->links[i].next = link.next;
+                anchor->links[i].width = link.width - (start - starts[i]);
+                link.next = anchor;
+                link.width = start - starts[i];
+            }
+        }
+
+        // Moves everything past the first kSegment nodes of `anchor` into a segment of its own.
+        void split(Anchor *anchor, Anchor **update, size_t *starts) {
+            Node *node = anchor->node;
+            for (size_t step = 0; step < kSegment; step++)
+                node = node->getNext();
+            Anchor *half = createAnchorOrInvalidate(node);
+            if (half == nullptr)
+                return;
+            for (size_t i = 0; i < anchor->links.size(); i++) {
+                update[i] = anchor;
+                starts[i] = starts[0];
+            }
+            linkAnchor(half, starts[0] + kSegment, update, starts);
+        }
+
+        Anchor *createAnchor(Node *node) {
+            size_t levels = 1;
+            // One anchor in four reaches the next level.
+            while (levels < kMaxLevel && (random_() & 3) == 0)
+                levels++;
+            return new Anchor{node, std::vector<Link>(levels)};
+        }
+
+        // The index is only an accelerator: rather than fail the list operation
+        // that is being recorded, drop it and let the next lookup rebuild it.
+        Anchor *createAnchorOrInvalidate(Node *node) {
+            try {
+                return createAnchor(node);
+            } catch (const std::bad_alloc &) {
+                invalidate();
+                return nullptr;
+            }
+        }
+
+        Anchor head_;
+        size_t size_ = 0;
+        bool valid_ = false;
+        std::minstd_rand random_;
+    };
+
+
+    template <typename Node>
+    const size_t PositionIndex<Node>::kSegment;
+
+    template <typename Node>
+    const size_t PositionIndex<Node>::kMaxLevel;
+}
@@ -1,11 +1,17 @@
 #include <algorithm>
 #include <iostream>
+#include <limits>
 #include <list>
 #include <random>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "concurrent_deque.h"
 #include "list.h"
+#include "unrolled_list.h"
+#include "xor_list.h"
 
 size_t RandomUInt(size_t max = -1) {
     static std::mt19937 rand(std::random_device{}());
@@ -65,6 +71,66 @@ bool EqualWrapper(T cont1, T_ cont2) {
     ASSERT_TRUE_MSG(EqualWrapper(cont1, cont2), msg)
 
 
+// Runs the same 20000 random operations on both lists, checking the sizes
+// after each one and the contents at the end.
+template <class List>
+void FuzzAgainstStd(List& list_task, std::list<int>& list_std, const std::string& name) {
+    for (size_t iter = 0; iter < 20000; ++iter) {
+        size_t case_type = list_task.empty() ? 0 : RandomUInt(6);
+        switch (case_type) {
+            case 0:
+            case 1: {
+                int val = RandomUInt(50);
+                if (TossCoin()) {
+                    list_task.push_back(val);
+                    list_std.push_back(val);
+                } else {
+                    list_task.push_front(val);
+                    list_std.push_front(val);
+                }
+                break;
+            }
+            case 2: {
+                if (TossCoin()) {
+                    list_task.pop_back();
+                    list_std.pop_back();
+                } else {
+                    list_task.pop_front();
+                    list_std.pop_front();
+                }
+                break;
+            }
+            case 3: {
+                list_task.remove(list_task.front());
+                list_std.remove(list_std.front());
+                break;
+            }
+            case 4: {
+                list_task.unique();
+                list_std.unique();
+                break;
+            }
+            case 5: {
+                size_t count = RandomUInt(list_std.size() + 100);
+                list_task.resize(count);
+                list_std.resize(count);
+                break;
+            }
+            case 6: {
+                list_task.sort();
+                list_std.sort();
+                break;
+            }
+        }
+        ASSERT_TRUE(list_task.size() == list_std.size())
+    }
+
+    ASSERT_EQUAL_MSG(list_task, list_std, name)
+    ASSERT_TRUE(std::equal(list_std.rbegin(), list_std.rend(),
+                           std::reverse_iterator<typename List::iterator>(list_task.end())))
+}
+
+
 int main() {
 
     {
@@ -209,4 +275,448 @@ int main() {
             }
         }
     }
-}
\ No newline at end of file
+
+    {
+        task::unrolled_list list_task;
+        std::list<int> list_std;
+
+        FuzzAgainstStd(list_task, list_std, "unrolled_list");
+
+        task::unrolled_list copy = list_task;
+        if (!copy.empty()) {
+            copy.remove(copy.back());
+            list_std.remove(list_std.back());
+        }
+        ASSERT_EQUAL_MSG(copy, list_std, "unrolled_list::remove")
+        ASSERT_TRUE(copy.block_count() ==
+                    (copy.size() + task::unrolled_list::kBlockCapacity - 1) /
+                    task::unrolled_list::kBlockCapacity)
+    }
+
+    {
+        task::list list_task;
+        std::list<int> list_std;
+        for (size_t round = 0; round < 200; ++round) {
+            int val = RandomUInt(100);
+            list_task.push_back(val);
+            list_std.push_back(val);
+            if (TossCoin()) {
+                list_task.push_back(val);
+                list_std.push_back(val);
+            }
+
+            int modulo = RandomUInt(1, 5);
+            auto pred = [modulo](int element) { return element % modulo == 0; };
+            auto same_tens = [](int first, int second) { return first / 10 == second / 10; };
+            if (round % 20 == 0) {
+                list_task.remove_if(pred);
+                list_std.remove_if(pred);
+            } else if (round % 20 == 10) {
+                list_task.unique(same_tens);
+                list_std.unique(same_tens);
+            }
+            ASSERT_EQUAL_MSG(list_task, list_std, "list::remove_if, list::unique")
+            ASSERT_TRUE(list_task.size() == list_std.size())
+        }
+        list_task.remove_if([](int) { return true; });
+        ASSERT_TRUE(list_task.empty() && list_task.begin() == list_task.end())
+
+        // A throwing predicate leaves a valid list: what was matched so far is gone.
+        RandomFill(list_task, 100, 9);
+        list_std.assign(list_task.begin(), list_task.end());
+        size_t calls = 0;
+        auto throwing = [&calls](int element) {
+            if (++calls == 50)
+                throw std::runtime_error("predicate");
+            return element < 5;
+        };
+        bool thrown = false;
+        try {
+            list_task.remove_if(throwing);
+        } catch (const std::runtime_error &) {
+            thrown = true;
+        }
+        auto split = std::next(list_std.begin(), 49);
+        list_std.erase(std::remove_if(list_std.begin(), split, [](int element) { return element < 5; }), split);
+        ASSERT_TRUE(thrown)
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::remove_if with a throwing predicate")
+        ASSERT_TRUE(list_task.size() == list_std.size())
+        ASSERT_TRUE(std::equal(list_std.rbegin(), list_std.rend(),
+                               std::reverse_iterator<task::list::iterator>(list_task.end())))
+    }
+
+    {
+        task::list list_task;
+        std::vector<int> vector_std;
+
+        for (size_t iter = 0; iter < 30000; ++iter) {
+            size_t case_type = vector_std.empty() ? 0 : RandomUInt(9);
+            switch (case_type) {
+                case 0:
+                case 1: {
+                    size_t pos = RandomUInt(vector_std.size());
+                    int val = RandomUInt(1000);
+                    list_task.insert_at(pos, val);
+                    vector_std.insert(vector_std.begin() + pos, val);
+                    break;
+                }
+                case 2: {
+                    size_t pos = RandomUInt(vector_std.size() - 1);
+                    ASSERT_TRUE_MSG(list_task.at(pos) == vector_std[pos], "list::at")
+                    list_task.at(pos) = -static_cast<int>(pos);
+                    vector_std[pos] = -static_cast<int>(pos);
+                    break;
+                }
+                case 3: {
+                    int val = RandomUInt(1000);
+                    if (TossCoin()) {
+                        list_task.push_back(val);
+                        vector_std.push_back(val);
+                    } else {
+                        list_task.push_front(val);
+                        vector_std.insert(vector_std.begin(), val);
+                    }
+                    break;
+                }
+                case 4: {
+                    if (TossCoin()) {
+                        list_task.pop_back();
+                        vector_std.pop_back();
+                    } else {
+                        list_task.pop_front();
+                        vector_std.erase(vector_std.begin());
+                    }
+                    break;
+                }
+                case 5: {
+                    if (RandomUInt(50) != 0)
+                        break;
+                    int val = list_task.at(RandomUInt(vector_std.size() - 1));
+                    list_task.remove(val);
+                    vector_std.erase(std::remove(vector_std.begin(), vector_std.end(), val), vector_std.end());
+                    break;
+                }
+                case 6: {
+                    if (RandomUInt(50) != 0)
+                        break;
+                    list_task.unique();
+                    vector_std.erase(std::unique(vector_std.begin(), vector_std.end()), vector_std.end());
+                    break;
+                }
+                case 7: {
+                    if (RandomUInt(50) != 0)
+                        break;
+                    list_task.sort();
+                    std::stable_sort(vector_std.begin(), vector_std.end());
+                    break;
+                }
+                case 8: {
+                    if (RandomUInt(50) != 0)
+                        break;
+                    size_t count = RandomUInt(vector_std.size() + 100);
+                    list_task.resize(count);
+                    vector_std.resize(count);
+                    break;
+                }
+                case 9: {
+                    size_t pos = RandomUInt(vector_std.size() - 1);
+                    list_task.erase(std::next(list_task.begin(), pos));
+                    vector_std.erase(vector_std.begin() + pos);
+                    break;
+                }
+            }
+            ASSERT_TRUE(list_task.size() == vector_std.size())
+        }
+
+        ASSERT_EQUAL_MSG(list_task, vector_std, "list::insert_at")
+        for (size_t pos = 0; pos < vector_std.size(); ++pos)
+            ASSERT_TRUE_MSG(list_task.at(pos) == vector_std[pos], "list::at")
+
+        bool thrown = false;
+        try {
+            list_task.at(vector_std.size());
+        } catch (const std::out_of_range &) {
+            thrown = true;
+        }
+        ASSERT_TRUE(thrown)
+
+        const task::list moved = std::move(list_task);
+        ASSERT_TRUE(moved.empty() || moved.at(moved.size() - 1) == vector_std.back())
+
+        // A copy has no index, so const at() walks instead of building one.
+        const task::list copy = moved;
+        for (size_t pos = 0; pos < vector_std.size(); ++pos)
+            ASSERT_TRUE_MSG(copy.at(pos) == vector_std[pos], "list::at const")
+    }
+
+    {
+        task::xor_list list_task;
+        std::list<int> list_std;
+
+        FuzzAgainstStd(list_task, list_std, "xor_list");
+        ASSERT_TRUE(list_task.empty() || (list_task.front() == list_std.front() &&
+                                          list_task.back() == list_std.back()))
+
+        task::xor_list copy = list_task;
+        if (!copy.empty()) {
+            copy.remove(copy.back());
+            list_std.remove(list_std.back());
+        }
+        ASSERT_EQUAL_MSG(copy, list_std, "xor_list::remove")
+
+        task::xor_list moved = std::move(copy);
+        ASSERT_TRUE(copy.empty() && copy.begin() == copy.end())
+        copy = moved;
+        moved.clear();
+        moved.push_back(1);
+        ASSERT_EQUAL_MSG(copy, list_std, "xor_list copy assignment")
+        ASSERT_TRUE(moved.size() == 1 && moved.front() == 1 && moved.back() == 1)
+    }
+
+    {
+        task::list list_task;
+        std::list<int> list_std;
+        RandomFill(list_task, 1000, 100);
+        list_std.assign(list_task.begin(), list_task.end());
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::iterator")
+
+        auto it_task = list_task.begin();
+        auto it_std = list_std.begin();
+        std::advance(it_task, 10);
+        std::advance(it_std, 10);
+        it_task = list_task.insert(it_task, -1);
+        it_std = list_std.insert(it_std, -1);
+        ASSERT_TRUE(*it_task == -1)
+        it_task = list_task.erase(std::next(it_task), std::next(it_task, 5));
+        it_std = list_std.erase(std::next(it_std), std::next(it_std, 5));
+        ASSERT_TRUE(*it_task == *it_std)
+        list_task.erase(--list_task.end());
+        list_std.erase(--list_std.end());
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::insert / list::erase")
+
+        task::list other_task;
+        RandomFill(other_task, 500, 100);
+        std::list<int> other_std(other_task.begin(), other_task.end());
+
+        list_task.splice(std::next(list_task.begin(), 3), other_task,
+                         std::next(other_task.begin(), 7), std::prev(other_task.end(), 9));
+        list_std.splice(std::next(list_std.begin(), 3), other_std,
+                        std::next(other_std.begin(), 7), std::prev(other_std.end(), 9));
+        ASSERT_TRUE(list_task.size() == list_std.size() && other_task.size() == other_std.size())
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::splice")
+        ASSERT_EQUAL_MSG(other_task, other_std, "list::splice")
+
+        {
+            task::list temporary(20, 7);
+            list_task.splice(list_task.end(), temporary, temporary.begin());
+            list_task.splice(list_task.begin(), temporary);
+            ASSERT_TRUE(temporary.empty())
+            list_std.push_back(7);
+            list_std.insert(list_std.begin(), 19, 7);
+        }
+        // nodes taken from `temporary` outlive it
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::splice")
+
+        list_task.sort();
+        list_std.sort();
+        other_task.sort();
+        other_std.sort();
+        list_task.merge(other_task);
+        list_std.merge(other_std);
+        ASSERT_TRUE(other_task.empty())
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::merge")
+        ASSERT_TRUE(std::equal(list_std.rbegin(), list_std.rend(),
+                               std::reverse_iterator<task::list::iterator>(list_task.end())))
+
+        // both pools shared with third lists: splice degrades to copying
+        task::list first, second, third, fourth;
+        first.push_back(1);
+        second.push_back(2);
+        third.push_back(3);
+        fourth.push_back(4);
+        first.splice(first.end(), second);
+        third.splice(third.end(), fourth);
+        first.splice(first.end(), third);
+        second.clear();
+        fourth.clear();
+        ASSERT_EQUAL_MSG(first, std::vector<int>({1, 2, 3, 4}), "list::splice")
+    }
+
+    {
+        task::list list_task;
+        std::vector<int> values;
+        for (size_t i = 0; i < 5000; ++i) {
+            int val = static_cast<int>(RandomUInt());
+            if (i % 7 == 0)
+                val = static_cast<int>(RandomUInt(20)) - 10;
+            list_task.push_back(val);
+            values.push_back(val);
+        }
+        list_task.push_back(std::numeric_limits<int>::min());
+        list_task.push_front(std::numeric_limits<int>::max());
+        values.push_back(std::numeric_limits<int>::min());
+        values.push_back(std::numeric_limits<int>::max());
+
+        list_task.radix_sort();
+        std::sort(values.begin(), values.end());
+        ASSERT_EQUAL_MSG(list_task, values, "list::radix_sort")
+        ASSERT_TRUE(list_task.size() == values.size())
+        ASSERT_TRUE(std::equal(values.rbegin(), values.rend(),
+                               std::reverse_iterator<task::list::iterator>(list_task.end())))
+    }
+
+    {
+        // Keys that only differ in their two low bytes, then the sorted result again.
+        task::list list_task;
+        std::vector<int> values;
+        for (size_t i = 0; i < 5000; ++i) {
+            int val = (1 << 20) + static_cast<int>(RandomUInt(40000));
+            list_task.push_back(val);
+            values.push_back(val);
+        }
+
+        std::sort(values.begin(), values.end());
+        for (int round = 0; round < 2; ++round) {
+            list_task.radix_sort();
+            ASSERT_EQUAL_MSG(list_task, values, "list::radix_sort")
+            ASSERT_TRUE(std::equal(values.rbegin(), values.rend(),
+                                   std::reverse_iterator<task::list::iterator>(list_task.end())))
+        }
+    }
+
+    {
+        for (size_t threads : {0, 1, 3, 4}) {
+            task::list list_task;
+            RandomFill(list_task, 5 * task::list::kParallelSortMinSegment + RandomUInt(1000), 1000);
+            std::list<int> list_std = ToStdList(list_task);
+
+            list_task.parallel_sort(threads);
+            list_std.sort();
+            ASSERT_EQUAL_MSG(list_task, list_std, "list::parallel_sort")
+            ASSERT_TRUE(list_task.size() == list_std.size())
+            ASSERT_TRUE(std::equal(list_std.rbegin(), list_std.rend(),
+                                   std::reverse_iterator<task::list::iterator>(list_task.end())))
+        }
+    }
+
+    {
+        task::list source(1000, 5);
+        source.push_front(1);
+        task::list moved(std::move(source));
+        ASSERT_TRUE(source.empty() && moved.size() == 1001)
+        ASSERT_TRUE(moved.front() == 1 && moved.back() == 5)
+        source.push_back(3);
+        ASSERT_TRUE(source.size() == 1 && source.front() == 3)
+
+        task::list target(10, 4);
+        target = std::move(moved);
+        ASSERT_TRUE(moved.empty() && target.size() == 1001)
+        moved = std::move(target);
+        ASSERT_TRUE(target.empty() && moved.size() == 1001)
+        target.swap(moved);
+        ASSERT_TRUE(moved.empty() && target.size() == 1001 && target.front() == 1)
+
+        std::vector<task::list> lists(3, task::list(3, 9));
+        lists.emplace_back(std::move(target));
+        lists.resize(100);
+        ASSERT_TRUE(lists[3].size() == 1001 && lists[0].back() == 9)
+
+        task::list shorter(5, 1);
+        task::list longer(50, 2);
+        std::list<int> expected(50, 2);
+        shorter = longer;
+        ASSERT_EQUAL_MSG(shorter, expected, "Assignment operator")
+        longer.assign(7, 8);
+        expected.assign(7, 8);
+        ASSERT_EQUAL_MSG(longer, expected, "list::assign")
+        shorter = longer;
+        ASSERT_EQUAL_MSG(shorter, expected, "Assignment operator")
+        shorter.assign(20, -1);
+        expected.assign(20, -1);
+        ASSERT_EQUAL_MSG(shorter, expected, "list::assign")
+    }
+
+    {
+        const size_t THREAD_COUNT = 8;
+        const int ITER_COUNT = 20000;
+
+        task::concurrent_deque deque;
+        std::vector<long long> popped_sums(THREAD_COUNT, 0);
+        std::vector<size_t> popped_counts(THREAD_COUNT, 0);
+        std::vector<std::thread> threads;
+
+        for (size_t thread = 0; thread < THREAD_COUNT; ++thread) {
+            threads.emplace_back([&, thread] {
+                int value;
+                for (int i = 1; i <= ITER_COUNT; ++i) {
+                    // Even threads keep the deque short so both locking modes are hit.
+                    if (thread % 2 == 0 || i % 3 != 0) {
+                        if (i % 2 == 0)
+                            deque.push_back(i);
+                        else
+                            deque.push_front(i);
+                    }
+                    bool ok = (i + thread) % 2 == 0 ? deque.pop_back(value) : deque.pop_front(value);
+                    if (ok) {
+                        popped_sums[thread] += value;
+                        popped_counts[thread]++;
+                    }
+                }
+            });
+        }
+        for (std::thread &thread : threads)
+            thread.join();
+
+        long long pushed_sum = 0;
+        size_t pushed_count = 0;
+        for (size_t thread = 0; thread < THREAD_COUNT; ++thread) {
+            for (int i = 1; i <= ITER_COUNT; ++i) {
+                if (thread % 2 == 0 || i % 3 != 0) {
+                    pushed_sum += i;
+                    pushed_count++;
+                }
+            }
+        }
+
+        long long popped_sum = 0;
+        size_t popped_count = 0;
+        for (size_t thread = 0; thread < THREAD_COUNT; ++thread) {
+            popped_sum += popped_sums[thread];
+            popped_count += popped_counts[thread];
+        }
+        int value;
+        while (deque.pop_front(value)) {
+            popped_sum += value;
+            popped_count++;
+        }
+        ASSERT_TRUE(deque.empty() && !deque.pop_back(value))
+        ASSERT_TRUE_MSG(popped_count == pushed_count, "concurrent_deque: element count")
+        ASSERT_TRUE_MSG(popped_sum == pushed_sum, "concurrent_deque: element sum")
+    }
+
+    {
+        // Nodes freed by the consumer have to find their way back to the producer.
+        const int ITER_COUNT = 100000;
+
+        task::concurrent_deque deque;
+        long long popped_sum = 0;
+        std::thread producer([&] {
+            for (int i = 1; i <= ITER_COUNT; ++i)
+                deque.push_back(i);
+        });
+        std::thread consumer([&] {
+            int value;
+            for (int popped = 0; popped < ITER_COUNT;) {
+                if (deque.pop_front(value)) {
+                    popped_sum += value;
+                    popped++;
+                }
+            }
+        });
+        producer.join();
+        consumer.join();
+
+        ASSERT_TRUE(deque.empty())
+        ASSERT_TRUE_MSG(popped_sum == 1LL * ITER_COUNT * (ITER_COUNT + 1) / 2, "concurrent_deque: handoff sum")
+    }
+}
@@ -0,0 +1,241 @@
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include "unrolled_list.h"
+
+using namespace task;
+
+constexpr uint32_t unrolled_list::kBlockBytes;
+constexpr uint32_t unrolled_list::kBlockCapacity;
+
+
+unrolled_list::unrolled_list() {
+    NIL->next = NIL;
+    NIL->prev = NIL;
+}
+
+unrolled_list::unrolled_list(size_t count, const int &value) : unrolled_list() {
+    for (size_t i = 0; i < count; i++)
+        push_back(value);
+}
+
+unrolled_list::unrolled_list(const unrolled_list &other) : unrolled_list() {
+    for (const Block *block = other.NIL->next; block != other.NIL; block = block->next) {
+        for (uint32_t i = block->begin; i < block->end; i++)
+            push_back(block->values[i]);
+    }
+}
+
+unrolled_list::~unrolled_list() {
+    delete NIL;
+}
+
+unrolled_list &unrolled_list::operator=(const unrolled_list &other) {
+    if (this != &other) {
+        unrolled_list copy(other);
+        swap(copy);
+    }
+    return *this;
+}
+
+int &unrolled_list::front() {
+    if (size_ == 0)
+        throw std::logic_error("Cannot take front from empty list!");
+    return NIL->next->values[NIL->next->begin];
+}
+
+const int &unrolled_list::front() const {
+    if (size_ == 0)
+        throw std::logic_error("Cannot take front from empty list!");
+    return NIL->next->values[NIL->next->begin];
+}
+
+int &unrolled_list::back() {
+    if (size_ == 0)
+        throw std::logic_error("Cannot take back from empty list!");
+    return NIL->prev->values[NIL->prev->end - 1];
+}
+
+const int &unrolled_list::back() const {
+    if (size_ == 0)
+        throw std::logic_error("Cannot take back from empty list!");
+    return NIL->prev->values[NIL->prev->end - 1];
+}
+
+unrolled_list::iterator unrolled_list::begin() {
+    return iterator(NIL->next, NIL->next->begin);
+}
+
+unrolled_list::const_iterator unrolled_list::begin() const {
+    return const_iterator(NIL->next, NIL->next->begin);
+}
+
+unrolled_list::iterator unrolled_list::end() {
+    return iterator(NIL, 0);
+}
+
+unrolled_list::const_iterator unrolled_list::end() const {
+    return const_iterator(NIL, 0);
+}
+
+bool unrolled_list::empty() const {
+    return size_ == 0;
+}
+
+size_t unrolled_list::size() const {
+    return size_;
+}
+
+void unrolled_list::clear() {
+    NIL->next = NIL;
+    NIL->prev = NIL;
+    pool_.release();
+    size_ = 0;
+}
+
+void unrolled_list::push_back(const int &value) {
+    Block *last = NIL->prev;
+    if (last == NIL || last->end == kBlockCapacity)
+        last = insertBlock(NIL, 0);
+    last->values[last->end++] = value;
+    size_++;
+}
+
+void unrolled_list::pop_back() {
+    Block *last = NIL->prev;
+    if (last == NIL)
+        throw std::logic_error("Cannot pop from empty list!");
+    if (--last->end == last->begin)
+        eraseBlock(last);
+    size_--;
+}
+
+void unrolled_list::push_front(const int &value) {
+    Block *first = NIL->next;
+    if (first == NIL || first->begin == 0)
+        first = insertBlock(first, kBlockCapacity);
+    first->values[--first->begin] = value;
+    size_++;
+}
+
+void unrolled_list::pop_front() {
+    Block *first = NIL->next;
+    if (first == NIL)
+        throw std::logic_error("Cannot pop from empty list!");
+    if (++first->begin == first->end)
+        eraseBlock(first);
+    size_--;
+}
+
+void unrolled_list::resize(size_t count) {
+    while (size_ > count) {
+        Block *last = NIL->prev;
+        uint32_t drop = static_cast<uint32_t>(
+                std::min<size_t>(size_ - count, last->end - last->begin));
+        last->end -= drop;
+        size_ -= drop;
+        if (last->end == last->begin)
+            eraseBlock(last);
+    }
+    while (size_ < count)
+        push_back(0);
+}
+
+void unrolled_list::swap(unrolled_list &other) {
+    std::swap(NIL, other.NIL);
+    std::swap(size_, other.size_);
+    pool_.swap(other.pool_);
+}
+
+void unrolled_list::remove(const int &value_ref) {
+    const int value = value_ref;
+    repack([value](int current) { return current != value; });
+}
+
+void unrolled_list::unique() {
+    bool first = true;
+    int last = 0;
+    repack([&first, &last](int current) {
+        if (!first && current == last)
+            return false;
+        first = false;
+        last = current;
+        return true;
+    });
+}
+
+void unrolled_list::sort() {
+    if (size_ < 2)
+        return;
+    std::vector<int> values(begin(), end());
+    std::sort(values.begin(), values.end());
+    auto next = values.begin();
+    repack([&next](int &current) {
+        current = *next++;
+        return true;
+    });
+}
+
+size_t unrolled_list::block_count() const {
+    size_t count = 0;
+    for (const Block *block = NIL->next; block != NIL; block = block->next)
+        count++;
+    return count;
+}
+
+size_t unrolled_list::memory_usage() const {
+    return pool_.bytes();
+}
+
+unrolled_list::Block *unrolled_list::insertBlock(Block *before, uint32_t position) {
+    Block *block = pool_.create();
+    block->begin = position;
+    block->end = position;
+    block->next = before;
+    block->prev = before->prev;
+    before->prev->next = block;
+    before->prev = block;
+    return block;
+}
+
+void unrolled_list::eraseBlock(Block *block) {
+    block->prev->next = block->next;
+    block->next->prev = block->prev;
+    pool_.destroy(block);
+}
+
+template <class Keep>
+void unrolled_list::repack(Keep keep) {
+    // The writer never overtakes the reader: every block before the writer's
+    // one is full, while the reader has consumed at most that many elements.
+    Block *write_block = NIL->next;
+    uint32_t write_index = 0;
+    size_t kept = 0;
+
+    for (Block *block = NIL->next; block != NIL; block = block->next) {
+        uint32_t end = block->end;
+        for (uint32_t i = block->begin; i < end; i++) {
+            int &current = block->values[i];
+            if (!keep(current))
+                continue;
+            if (write_index == kBlockCapacity) {
+                write_block->begin = 0;
+                write_block->end = kBlockCapacity;
+                write_block = write_block->next;
+                write_index = 0;
+            }
+            write_block->values[write_index++] = current;
+            kept++;
+        }
+    }
+
+    if (kept == 0) {
+        clear();
+        return;
+    }
+    write_block->begin = 0;
+    write_block->end = write_index;
+    while (write_block->next != NIL)
+        eraseBlock(write_block->next);
+    size_ = kept;
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+#include "node_pool.h"
+
+
+namespace task {
+
+
+    // Unrolled variant of task::list: every node is a small block holding up to
+    // kBlockCapacity ints in [begin, end), so traversal touches one cache line per
+    // several elements instead of one per element. Elements do not have stable
+    // addresses: remove(), unique() and sort() repack the blocks.
+    class unrolled_list {
+
+    private:
+        class Block;
+
+    public:
+        template <class Value, class BlockPtr>
+        class basic_iterator {
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = int;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Value *;
+            using reference = Value &;
+
+            basic_iterator() = default;
+
+            basic_iterator(BlockPtr block, uint32_t index) : block_(block), index_(index) {
+            }
+
+            // iterator -> const_iterator
+            template <class OtherValue, class OtherBlockPtr>
+            basic_iterator(const basic_iterator<OtherValue, OtherBlockPtr> &other)
+                : block_(other.block_), index_(other.index_) {
+            }
+
+            reference operator*() const {
+                return block_->values[index_];
+            }
+
+            pointer operator->() const {
+                return &block_->values[index_];
+            }
+
+            basic_iterator &operator++() {
+                if (++index_ == block_->end) {
+                    block_ = block_->next;
+                    index_ = block_->begin;
+                }
+                return *this;
+            }
+
+            basic_iterator operator++(int) {
+                basic_iterator copy(*this);
+                ++*this;
+                return copy;
+            }
+
+            basic_iterator &operator--() {
+                if (index_ == block_->begin) {
+                    block_ = block_->prev;
+                    index_ = block_->end;
+                }
+                --index_;
+                return *this;
+            }
+
+            basic_iterator operator--(int) {
+                basic_iterator copy(*this);
+                --*this;
+                return copy;
+            }
+
+            bool operator==(const basic_iterator &other) const {
+                return block_ == other.block_ && index_ == other.index_;
+            }
+
+            bool operator!=(const basic_iterator &other) const {
+                return !(*this == other);
+            }
+
+        private:
+            template <class, class>
+            friend class basic_iterator;
+
+            BlockPtr block_ = nullptr;
+            uint32_t index_ = 0;
+        };
+
+        using iterator = basic_iterator<int, Block *>;
+        using const_iterator = basic_iterator<const int, const Block *>;
+
+
+        unrolled_list();
+
+        unrolled_list(size_t count, const int &value = int());
+
+        unrolled_list(const unrolled_list &other);
+
+        ~unrolled_list();
+
+        unrolled_list &operator=(const unrolled_list &other);
+
+
+        int &front();
+
+        const int &front() const;
+
+        int &back();
+
+        const int &back() const;
+
+
+        iterator begin();
+
+        const_iterator begin() const;
+
+        iterator end();
+
+        const_iterator end() const;
+
+
+        bool empty() const;
+
+        size_t size() const;
+
+        void clear();
+
+
+        void push_back(const int &value);
+
+        void pop_back();
+
+        void push_front(const int &value);
+
+        void pop_front();
+
+        void resize(size_t count);
+
+        void swap(unrolled_list &other);
+
+
+        void remove(const int &value);
+
+        void unique();
+
+        void sort();
+
+        // Number of blocks currently linked, for memory accounting.
+        size_t block_count() const;
+
+        // Bytes held by the block pool, sentinel excluded.
+        size_t memory_usage() const;
+
+        static constexpr uint32_t kBlockBytes = 256;
+
+    private:
+        class Block {
+        public:
+            // user-provided so that pooled blocks skip zeroing `values`
+            Block() {
+            }
+
+            Block *next = nullptr;
+            Block *prev = nullptr;
+            uint32_t begin = 0;
+            uint32_t end = 0;
+            int values[(kBlockBytes - 2 * sizeof(Block *) - 2 * sizeof(uint32_t)) / sizeof(int)];
+        };
+
+    public:
+        static constexpr uint32_t kBlockCapacity = sizeof(Block::values) / sizeof(int);
+
+    private:
+        Block *insertBlock(Block *before, uint32_t position);
+
+        void eraseBlock(Block *block);
+
+        // Rewrites the elements accepted by `keep` densely into the leading
+        // blocks and frees the blocks left over.
+        template <class Keep>
+        void repack(Keep keep);
+
+        Block *NIL = new Block();
+        size_t size_ = 0;
+        NodePool<Block> pool_;
+    };
+}
@@ -0,0 +1,262 @@
+#include <stdexcept>
+#include <utility>
+#include "xor_list.h"
+
+using namespace task;
+
+
+xor_list::xor_list() = default;
+
+xor_list::xor_list(size_t count, const int &value) {
+    pool_.reserve(count);
+    for (size_t i = 0; i < count; i++)
+        push_back(value);
+}
+
+xor_list::xor_list(const xor_list &other) {
+    pool_.reserve(other.size_);
+    for (int value : other)
+        push_back(value);
+}
+
+xor_list::xor_list(xor_list &&other) noexcept {
+    swap(other);
+}
+
+xor_list::~xor_list() = default;
+
+xor_list &xor_list::operator=(const xor_list &other) {
+    if (this != &other) {
+        xor_list copy(other);
+        swap(copy);
+    }
+    return *this;
+}
+
+xor_list &xor_list::operator=(xor_list &&other) noexcept {
+    if (this != &other) {
+        clear();
+        swap(other);
+    }
+    return *this;
+}
+
+int &xor_list::front() {
+    if (head_ == nullptr)
+        throw std::logic_error("Cannot take front from empty list!");
+    return head_->value;
+}
+
+const int &xor_list::front() const {
+    if (head_ == nullptr)
+        throw std::logic_error("Cannot take front from empty list!");
+    return head_->value;
+}
+
+int &xor_list::back() {
+    if (tail_ == nullptr)
+        throw std::logic_error("Cannot take back from empty list!");
+    return tail_->value;
+}
+
+const int &xor_list::back() const {
+    if (tail_ == nullptr)
+        throw std::logic_error("Cannot take back from empty list!");
+    return tail_->value;
+}
+
+xor_list::iterator xor_list::begin() {
+    return iterator(nullptr, head_);
+}
+
+xor_list::const_iterator xor_list::begin() const {
+    return const_iterator(nullptr, head_);
+}
+
+xor_list::iterator xor_list::end() {
+    return iterator(tail_, nullptr);
+}
+
+xor_list::const_iterator xor_list::end() const {
+    return const_iterator(tail_, nullptr);
+}
+
+bool xor_list::empty() const {
+    return size_ == 0;
+}
+
+size_t xor_list::size() const {
+    return size_;
+}
+
+void xor_list::clear() {
+    // Nodes are trivially destructible, the pool frees their chunks wholesale.
+    pool_.release();
+    head_ = tail_ = nullptr;
+    size_ = 0;
+}
+
+void xor_list::push_back(const int &value) {
+    Node *newNode = pool_.create(value, tail_, nullptr);
+    if (tail_ != nullptr)
+        tail_->relink(nullptr, newNode);
+    else
+        head_ = newNode;
+    tail_ = newNode;
+    size_++;
+}
+
+void xor_list::pop_back() {
+    if (tail_ == nullptr)
+        throw std::logic_error("Cannot pop from empty list!");
+    remove(tail_->neighbour(nullptr), tail_, nullptr);
+}
+
+void xor_list::push_front(const int &value) {
+    Node *newNode = pool_.create(value, nullptr, head_);
+    if (head_ != nullptr)
+        head_->relink(nullptr, newNode);
+    else
+        tail_ = newNode;
+    head_ = newNode;
+    size_++;
+}
+
+void xor_list::pop_front() {
+    if (head_ == nullptr)
+        throw std::logic_error("Cannot pop from empty list!");
+    remove(nullptr, head_, head_->neighbour(nullptr));
+}
+
+void xor_list::resize(size_t count) {
+    if (size_ < count)
+        pool_.reserve(count - size_);
+    while (size_ < count)
+        push_back(0);
+    while (size_ > count)
+        pop_back();
+}
+
+void xor_list::swap(xor_list &other) {
+    std::swap(head_, other.head_);
+    std::swap(tail_, other.tail_);
+    std::swap(size_, other.size_);
+    pool_.swap(other.pool_);
+}
+
+void xor_list::remove(const int &value_ref) {
+    // value_ref may refer into a node that is about to be removed
+    const int value = value_ref;
+    Node *prev = nullptr;
+    Node *tmp = head_;
+    while (tmp != nullptr) {
+        Node *next = tmp->neighbour(prev);
+        if (tmp->value == value) {
+            remove(prev, tmp, next);
+        } else {
+            prev = tmp;
+        }
+        tmp = next;
+    }
+}
+
+void xor_list::unique() {
+    if (head_ == nullptr)
+        return;
+    Node *prev = head_;
+    Node *tmp = head_->neighbour(nullptr);
+    while (tmp != nullptr) {
+        Node *next = tmp->neighbour(prev);
+        if (tmp->value == prev->value) {
+            remove(prev, tmp, next);
+        } else {
+            prev = tmp;
+        }
+        tmp = next;
+    }
+}
+
+void xor_list::sort() {
+    if (size_ < 2)
+        return;
+
+    // Decode the links into plain next pointers, sort, then encode them back.
+    Node *prev = nullptr;
+    for (Node *tmp = head_; tmp != nullptr;) {
+        Node *next = tmp->neighbour(prev);
+        tmp->link = reinterpret_cast<uintptr_t>(next);
+        prev = tmp;
+        tmp = next;
+    }
+
+    head_ = sortChain(head_);
+
+    prev = nullptr;
+    for (Node *tmp = head_; tmp != nullptr;) {
+        Node *next = tmp->neighbour(nullptr);
+        tmp->relink(nullptr, prev);
+        prev = tmp;
+        tmp = next;
+    }
+    tail_ = prev;
+}
+
+size_t xor_list::memory_usage() const {
+    return pool_.bytes();
+}
+
+void xor_list::remove(Node *prev, Node *node, Node *next) {
+    if (prev != nullptr)
+        prev->relink(node, next);
+    else
+        head_ = next;
+    if (next != nullptr)
+        next->relink(node, prev);
+    else
+        tail_ = prev;
+    pool_.destroy(node);
+    size_--;
+}
+
+xor_list::Node *xor_list::sortChain(Node *head) {
+    // bins[i] holds a sorted run of 2^i nodes (or nothing), as in list::sortChain.
+    const size_t kBins = 64;
+    Node *bins[kBins] = {};
+    size_t used = 0;
+
+    while (head != nullptr) {
+        Node *carry = head;
+        head = head->neighbour(nullptr);
+        carry->link = 0;
+
+        size_t i = 0;
+        for (; i < used && bins[i] != nullptr; i++) {
+            carry = mergeChains(bins[i], carry);
+            bins[i] = nullptr;
+        }
+        if (i == used)
+            used++;
+        bins[i] = carry;
+    }
+
+    Node *result = nullptr;
+    for (size_t i = 0; i < used; i++) {
+        if (bins[i] != nullptr)
+            result = result == nullptr ? bins[i] : mergeChains(bins[i], result);
+    }
+    return result;
+}
+
+xor_list::Node *xor_list::mergeChains(Node *first, Node *second) {
+    // Ties are taken from `first`, which holds the earlier elements.
+    Node head(0, nullptr, nullptr);
+    Node *tail = &head;
+    while (first != nullptr && second != nullptr) {
+        Node *&from = second->value < first->value ? second : first;
+        tail->link = reinterpret_cast<uintptr_t>(from);
+        tail = from;
+        from = from->neighbour(nullptr);
+    }
+    tail->link = reinterpret_cast<uintptr_t>(first != nullptr ? first : second);
+    return head.neighbour(nullptr);
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+#include "node_pool.h"
+
+
+namespace task {
+
+
+    // Memory-compact variant of task::list: a node stores its value and a single
+    // link word, the XOR of the addresses of its neighbours (nullptr at the ends).
+    // Walking needs the previous node to decode the next one, so iterators carry
+    // two pointers and inserting next to a node invalidates iterators to it.
+    class xor_list {
+
+    private:
+        class Node;
+
+    public:
+        template <class Value>
+        class basic_iterator {
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type = int;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Value *;
+            using reference = Value &;
+
+            basic_iterator() = default;
+
+            basic_iterator(Node *prev, Node *node) : prev_(prev), node_(node) {
+            }
+
+            // iterator -> const_iterator
+            template <class OtherValue>
+            basic_iterator(const basic_iterator<OtherValue> &other)
+                : prev_(other.prev_), node_(other.node_) {
+            }
+
+            reference operator*() const {
+                return node_->value;
+            }
+
+            pointer operator->() const {
+                return &node_->value;
+            }
+
+            basic_iterator &operator++() {
+                Node *next = node_->neighbour(prev_);
+                prev_ = node_;
+                node_ = next;
+                return *this;
+            }
+
+            basic_iterator operator++(int) {
+                basic_iterator copy(*this);
+                ++*this;
+                return copy;
+            }
+
+            basic_iterator &operator--() {
+                Node *prev = prev_->neighbour(node_);
+                node_ = prev_;
+                prev_ = prev;
+                return *this;
+            }
+
+            basic_iterator operator--(int) {
+                basic_iterator copy(*this);
+                --*this;
+                return copy;
+            }
+
+            bool operator==(const basic_iterator &other) const {
+                return node_ == other.node_ && prev_ == other.prev_;
+            }
+
+            bool operator!=(const basic_iterator &other) const {
+                return !(*this == other);
+            }
+
+        private:
+            template <class>
+            friend class basic_iterator;
+
+            Node *prev_ = nullptr;
+            Node *node_ = nullptr;
+        };
+
+        using iterator = basic_iterator<int>;
+        using const_iterator = basic_iterator<const int>;
+
+
+        xor_list();
+
+        xor_list(size_t count, const int &value = int());
+
+        xor_list(const xor_list &other);
+
+        xor_list(xor_list &&other) noexcept;
+
+        ~xor_list();
+
+        xor_list &operator=(const xor_list &other);
+
+        xor_list &operator=(xor_list &&other) noexcept;
+
+
+        int &front();
+
+        const int &front() const;
+
+        int &back();
+
+        const int &back() const;
+
+
+        iterator begin();
+
+        const_iterator begin() const;
+
+        iterator end();
+
+        const_iterator end() const;
+
+
+        bool empty() const;
+
+        size_t size() const;
+
+        void clear();
+
+
+        void push_back(const int &value);
+
+        void pop_back();
+
+        void push_front(const int &value);
+
+        void pop_front();
+
+        void resize(size_t count);
+
+        void swap(xor_list &other);
+
+
+        void remove(const int &value);
+
+        void unique();
+
+        void sort();
+
+        // Bytes held by the node pool.
+        size_t memory_usage() const;
+
+    private:
+        class Node {
+        public:
+            Node(int value, Node *first, Node *second)
+                : link(reinterpret_cast<uintptr_t>(first) ^ reinterpret_cast<uintptr_t>(second)),
+                  value(value) {
+            }
+
+            // Given one neighbour returns the other.
+            Node *neighbour(const Node *known) const {
+                return reinterpret_cast<Node *>(link ^ reinterpret_cast<uintptr_t>(known));
+            }
+
+            // Replaces neighbour `from` with `to`.
+            void relink(const Node *from, const Node *to) {
+                link ^= reinterpret_cast<uintptr_t>(from) ^ reinterpret_cast<uintptr_t>(to);
+            }
+
+            uintptr_t link;
+            int value;
+        };
+
+        // Unlinks and frees `node`, whose neighbours are `prev` and `next`.
+        void remove(Node *prev, Node *node, Node *next);
+
+        // Stable merge sort of a chain whose links temporarily hold plain next pointers.
+        static Node *sortChain(Node *head);
+
+        static Node *mergeChains(Node *first, Node *second);
+
+        Node *head_ = nullptr;
+        Node *tail_ = nullptr;
+        size_t size_ = 0;
+        NodePool<Node> pool_;
+    };
+}